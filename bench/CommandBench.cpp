@@ -0,0 +1,418 @@
+// RCmdLaunch 基准测试：在临时数据目录中驱动 CommandManager，测量启动延迟、
+// 输出吞吐、界面信号频率、内存增长、批量启停和数据库加载耗时，结果以 JSON 输出，
+// 便于在不同版本之间对比。
+//
+//   RCmdLaunchBench [--json results.json] [--only launch,output,...] [--verbose]
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include "CommandManager.h"
+#include "DatabaseWorker.h"
+
+#ifndef RCMDLAUNCH_VERSION
+#define RCMDLAUNCH_VERSION "unknown"
+#endif
+
+namespace {
+
+struct Options {
+    int launches = 50;          // 每种启动方式的启动次数
+    int concurrent = 32;        // 同时启停的命令数
+    int rows = 10000;           // 数据库加载测试的命令数
+    int outputMb = 64;          // 输出吞吐测试产生的数据量
+    int stressCommands = 16;    // 压力测试中同时全速输出的命令数
+    int stressSeconds = 5;
+};
+
+bool s_verbose = false;
+
+void messageHandler(QtMsgType type, const QMessageLogContext&, const QString& message) {
+    // 默认只保留警告，避免管理器的调试日志干扰测量
+    if (type == QtDebugMsg && !s_verbose) return;
+    std::fprintf(stderr, "%s\n", qPrintable(message));
+}
+
+void report(const char* format, double value, const char* unit) {
+    std::fprintf(stderr, format, value, unit);
+}
+
+// 当前进程的常驻内存（KB），非 Linux 平台返回 -1
+qint64 selfRssKb() {
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : file.readAll().split('\n')) {
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+// 运行事件循环直到条件满足或超时
+bool waitUntil(const std::function<bool()>& done, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) return false;
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 20);
+    }
+    return true;
+}
+
+QJsonObject distribution(QList<double> samples) {
+    QJsonObject result;
+    result["count"] = samples.size();
+    if (samples.isEmpty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double v : std::as_const(samples)) total += v;
+    auto at = [&](double p) { return samples.at(qMin(samples.size() - 1, qsizetype(p * samples.size()))); };
+    result["avg"] = total / samples.size();
+    result["min"] = samples.first();
+    result["p50"] = at(0.50);
+    result["p95"] = at(0.95);
+    result["max"] = samples.last();
+    return result;
+}
+
+CommandEntry* entryOf(CommandManager& manager, const QString& name) {
+    for (QObject* object : manager.commandList()) {
+        auto* entry = qobject_cast<CommandEntry*>(object);
+        if (entry && entry->name() == name) return entry;
+    }
+    return nullptr;
+}
+
+bool waitLoaded(CommandManager& manager) {
+    return waitUntil([&]() { return manager.commandsLoaded(); }, 60000);
+}
+
+#ifdef Q_OS_WIN
+const QString QuickCommand = "exit 0";
+const QString SleepCommand = "ping -n 61 127.0.0.1 > nul";
+#else
+const QString QuickCommand = "true";
+const QString SleepCommand = "sleep 60";
+#endif
+
+// 数据库中已有 rows 条命令时，从构造 CommandManager 到分页加载完成的耗时
+QJsonObject benchDatabaseLoad(const QString& dir, int rows) {
+    {
+        DatabaseWorker store;
+        if (!store.open(dir + "/commands.db")) return { { "error", "cannot open database" } };
+        for (int i = 0; i < rows; ++i) {
+            store.insertCommand(i + 1, QString("cmd-%1").arg(i, 5, 10, QChar('0')), QString("echo %1").arg(i));
+        }
+        store.close();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    CommandManager manager(dir);
+    qint64 constructMs = timer.elapsed();
+    bool loaded = waitLoaded(manager);
+    qint64 loadMs = timer.elapsed();
+
+    QJsonObject result;
+    result["rows"] = rows;
+    result["loaded"] = int(manager.commandNames().size());
+    result["constructMs"] = constructMs;
+    result["loadMs"] = loadMs;
+    if (!loaded) result["error"] = "timeout";
+    report("db load:           %.0f %s\n", double(loadMs), "ms");
+    return result;
+}
+
+// 从调用 startCommand 到进程 exec 成功（running）的延迟，分别测 shell 和直接启动
+QJsonObject benchLaunch(const QString& dir, int launches) {
+    CommandManager manager(dir);
+    waitLoaded(manager);
+    qint64 quickId = manager.addCommand("quick", QuickCommand);
+
+    QJsonObject result;
+    for (int mode = 0; mode < 2; ++mode) {
+        if (mode == int(LaunchMode::Direct) && !manager.setLaunchMode(quickId, mode)) continue;
+
+        QList<double> startUs;
+        QList<double> roundTripUs;
+        for (int i = 0; i < launches; ++i) {
+            bool started = false;
+            bool finished = false;
+            QElapsedTimer timer;
+            auto c1 = QObject::connect(&manager, &CommandManager::commandStatusChanged,
+                                       [&](const QString&, bool running) {
+                                           if (running && !started) {
+                                               started = true;
+                                               startUs.append(timer.nsecsElapsed() / 1000.0);
+                                           }
+                                       });
+            auto c2 = QObject::connect(&manager, &CommandManager::commandFinished, [&]() {
+                finished = true;
+                roundTripUs.append(timer.nsecsElapsed() / 1000.0);
+            });
+            timer.start();
+            manager.startCommand("quick");
+            waitUntil([&]() { return finished; }, 10000);
+            QObject::disconnect(c1);
+            QObject::disconnect(c2);
+        }
+
+        QJsonObject item;
+        item["startUs"] = distribution(startUs);
+        item["roundTripUs"] = distribution(roundTripUs);
+        result[mode == 0 ? "shell" : "direct"] = item;
+        report(mode == 0 ? "launch (shell):    %.0f %s p50\n" : "launch (direct):   %.0f %s p50\n",
+               item["startUs"].toObject()["p50"].toDouble(), "us");
+    }
+    return result;
+}
+
+// 单个命令全速输出 outputMb 兆字节：吞吐、界面线程收到的刷新信号频率和内存增长
+QJsonObject benchOutput(const QString& dir, int outputMb) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(dir);
+    Q_UNUSED(outputMb);
+    return { { "skipped", "requires a POSIX shell" } };
+#else
+    CommandManager manager(dir);
+    waitLoaded(manager);
+
+    qint64 bytes = qint64(outputMb) * 1024 * 1024;
+    QString line(99, QChar('x'));
+    manager.addCommand("output", QString("yes %1 | head -c %2").arg(line).arg(bytes));
+
+    int updates = 0;
+    bool finished = false;
+    QObject::connect(&manager, &CommandManager::outputUpdated, [&]() { ++updates; });
+    QObject::connect(&manager, &CommandManager::commandFinished, [&]() { finished = true; });
+
+    qint64 rssBefore = selfRssKb();
+    QElapsedTimer timer;
+    timer.start();
+    manager.startCommand("output");
+    bool done = waitUntil([&]() { return finished; }, 300000);
+    double seconds = timer.nsecsElapsed() / 1e9;
+    qint64 rssAfter = selfRssKb();
+
+    CommandEntry* entry = entryOf(manager, "output");
+    QJsonObject result;
+    result["bytes"] = bytes;
+    result["seconds"] = seconds;
+    result["mbPerSec"] = outputMb / seconds;
+    result["uiSignals"] = updates;
+    result["uiSignalsPerSec"] = updates / seconds;
+    result["pipeReads"] = entry ? double(entry->totalChunks()) : 0.0;
+    result["maxReadsPerFlush"] = entry ? entry->maxFlushChunks() : 0;
+    result["retainedBytes"] = entry ? double(entry->outputEnd() - entry->outputStart()) : 0.0;
+    if (rssBefore >= 0) {
+        result["rssGrowthKb"] = double(rssAfter - rssBefore);
+        result["rssGrowthKbPerMb"] = double(rssAfter - rssBefore) / outputMb;
+    }
+    if (!done) result["error"] = "timeout";
+    report("output ingest:     %.1f %s\n", outputMb / seconds, "MB/s");
+    report("ui signals:        %.0f %s\n", updates / seconds, "/s");
+    return result;
+#endif
+}
+
+// 同时启动 count 个命令直到全部运行，再全部停止直到进程树退出
+QJsonObject benchConcurrent(const QString& dir, int count) {
+    CommandManager manager(dir);
+    waitLoaded(manager);
+    for (int i = 0; i < count; ++i) {
+        manager.addCommand(QString("sleep-%1").arg(i), SleepCommand);
+    }
+
+    int running = 0;
+    int stopped = 0;
+    int escalated = 0;
+    QObject::connect(&manager, &CommandManager::commandStatusChanged, [&](const QString&, bool isRunning) {
+        if (isRunning) ++running;
+    });
+    QObject::connect(&manager, &CommandManager::commandStopped, [&](const QString&, qint64, bool killed, int) {
+        ++stopped;
+        if (killed) ++escalated;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        manager.startCommand(QString("sleep-%1").arg(i));
+    }
+    bool allStarted = waitUntil([&]() { return running >= count; }, 60000);
+    qint64 startMs = timer.elapsed();
+
+    timer.restart();
+    for (int i = 0; i < count; ++i) {
+        manager.stopCommand(QString("sleep-%1").arg(i));
+    }
+    bool allStopped = waitUntil([&]() { return stopped >= count; }, 60000);
+    qint64 stopMs = timer.elapsed();
+
+    QJsonObject result;
+    result["commands"] = count;
+    result["startAllMs"] = startMs;
+    result["stopAllMs"] = stopMs;
+    result["escalated"] = escalated;
+    if (!allStarted || !allStopped) result["error"] = "timeout";
+    report("start all:         %.0f %s\n", double(startMs), "ms");
+    report("stop all:          %.0f %s\n", double(stopMs), "ms");
+    return result;
+}
+
+// 界面线程的帧间隔：空闲时和 commands 个命令同时全速输出时各测 seconds 秒
+QJsonObject benchStress(const QString& dir, int commands, int seconds) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(dir);
+    Q_UNUSED(commands);
+    Q_UNUSED(seconds);
+    return { { "skipped", "requires a POSIX shell" } };
+#else
+    constexpr int FrameMs = 16;
+    auto measureFrames = [&](int durationMs) {
+        QList<double> intervals;
+        QElapsedTimer clock;
+        QTimer frame;
+        frame.setTimerType(Qt::PreciseTimer);
+        qint64 last = -1;
+        QObject::connect(&frame, &QTimer::timeout, [&]() {
+            qint64 now = clock.nsecsElapsed();
+            if (last >= 0) intervals.append((now - last) / 1e6);
+            last = now;
+        });
+        clock.start();
+        frame.start(FrameMs);
+        waitUntil([&]() { return clock.elapsed() >= durationMs; }, durationMs + 1000);
+        return intervals;
+    };
+
+    CommandManager manager(dir);
+    waitLoaded(manager);
+    QJsonObject result;
+    result["commands"] = commands;
+    result["idleFrameMs"] = distribution(measureFrames(1000));
+
+    for (int i = 0; i < commands; ++i) {
+        manager.addCommand(QString("stress-%1").arg(i), QString("yes stress-%1-%2").arg(i).arg(QString(80, QChar('y'))));
+        manager.startCommand(QString("stress-%1").arg(i));
+    }
+    QElapsedTimer timer;
+    timer.start();
+    result["loadedFrameMs"] = distribution(measureFrames(seconds * 1000));
+    double elapsed = timer.nsecsElapsed() / 1e9;
+
+    qint64 bytes = 0;
+    for (int i = 0; i < commands; ++i) {
+        if (CommandEntry* entry = entryOf(manager, QString("stress-%1").arg(i))) {
+            bytes += entry->outputEnd();
+        }
+        manager.stopCommand(QString("stress-%1").arg(i));
+    }
+    waitUntil([&]() {
+        for (int i = 0; i < commands; ++i) {
+            if (manager.isRunning(QString("stress-%1").arg(i))) return false;
+        }
+        return true;
+    }, 30000);
+
+    result["ingestedMbPerSec"] = bytes / 1048576.0 / elapsed;
+    report("frame p95 (idle):  %.1f %s\n", result["idleFrameMs"].toObject()["p95"].toDouble(), "ms");
+    report("frame p95 (load):  %.1f %s\n", result["loadedFrameMs"].toObject()["p95"].toDouble(), "ms");
+    return result;
+#endif
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("RCmdLaunchBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("RCmdLaunch benchmark suite");
+    parser.addHelpOption();
+    QCommandLineOption jsonOption("json", "Write results to <file> instead of stdout.", "file");
+    QCommandLineOption onlyOption("only", "Comma separated benchmarks: db,launch,output,concurrent,stress.", "names");
+    QCommandLineOption launchesOption("launches", "Launches per launch mode.", "n", "50");
+    QCommandLineOption concurrentOption("concurrent", "Commands started and stopped together.", "n", "32");
+    QCommandLineOption rowsOption("rows", "Commands in the database load benchmark.", "n", "10000");
+    QCommandLineOption outputOption("output-mb", "Output produced by the ingestion benchmark.", "mb", "64");
+    QCommandLineOption stressOption("stress-commands", "Commands printing at full speed in the stress run.", "n", "16");
+    QCommandLineOption secondsOption("stress-seconds", "Duration of the stress run.", "s", "5");
+    QCommandLineOption verboseOption("verbose", "Show debug output of the launcher.");
+    parser.addOptions({ jsonOption, onlyOption, launchesOption, concurrentOption, rowsOption,
+                        outputOption, stressOption, secondsOption, verboseOption });
+    parser.process(app);
+
+    s_verbose = parser.isSet(verboseOption);
+    qInstallMessageHandler(messageHandler);
+
+    Options options;
+    options.launches = qMax(1, parser.value(launchesOption).toInt());
+    options.concurrent = qMax(1, parser.value(concurrentOption).toInt());
+    options.rows = qMax(1, parser.value(rowsOption).toInt());
+    options.outputMb = qMax(1, parser.value(outputOption).toInt());
+    options.stressCommands = qMax(1, parser.value(stressOption).toInt());
+    options.stressSeconds = qMax(1, parser.value(secondsOption).toInt());
+
+    QStringList only = parser.value(onlyOption).split(',', Qt::SkipEmptyParts);
+    auto enabled = [&](const QString& name) { return only.isEmpty() || only.contains(name); };
+
+    QTemporaryDir temp;
+    if (!temp.isValid()) {
+        std::fprintf(stderr, "cannot create temporary directory\n");
+        return 1;
+    }
+    // 每项测试使用独立的数据目录，互不影响
+    auto dirFor = [&](const QString& name) {
+        QString dir = temp.path() + "/" + name;
+        QDir().mkpath(dir);
+        return dir;
+    };
+
+    QJsonObject results;
+    if (enabled("db")) results["dbLoad"] = benchDatabaseLoad(dirFor("db"), options.rows);
+    if (enabled("launch")) results["launch"] = benchLaunch(dirFor("launch"), options.launches);
+    if (enabled("output")) results["output"] = benchOutput(dirFor("output"), options.outputMb);
+    if (enabled("concurrent")) results["concurrent"] = benchConcurrent(dirFor("concurrent"), options.concurrent);
+    if (enabled("stress")) results["stress"] = benchStress(dirFor("stress"), options.stressCommands, options.stressSeconds);
+
+    QJsonObject document;
+    document["benchmark"] = "RCmdLaunchBench";
+    document["version"] = RCMDLAUNCH_VERSION;
+    document["qt"] = qVersion();
+    document["platform"] = QSysInfo::prettyProductName();
+    document["cpu"] = QSysInfo::currentCpuArchitecture();
+    document["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    document["results"] = results;
+    QByteArray json = QJsonDocument(document).toJson();
+
+    if (parser.isSet(jsonOption)) {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(file.fileName()));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
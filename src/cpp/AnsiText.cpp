@@ -0,0 +1,367 @@
+#include "AnsiText.h"
+#include <QtGlobal>
+
+namespace Ansi {
+
+namespace {
+
+constexpr char Esc = '\x1b';
+constexpr qsizetype MaxSequenceLength = 256;   // 判断末尾是否有未结束序列时向前查找的范围
+
+// 针对深色输出背景调过亮度的 16 色
+const char* const BasePalette[16] = {
+    "#5c6370", "#ef5350", "#8bc34a", "#ffca28", "#42a5f5", "#ce93d8", "#26c6da", "#e8eaed",
+    "#9aa0a6", "#ff8a80", "#b9f6ca", "#ffe57f", "#82b1ff", "#ea80fc", "#84ffff", "#ffffff",
+};
+
+QString colorName(int index) {
+    if (index < 16) {
+        return QString::fromLatin1(BasePalette[index]);
+    }
+    int r, g, b;
+    if (index < 232) {
+        // 6x6x6 色立方
+        static const int levels[6] = { 0, 95, 135, 175, 215, 255 };
+        int i = index - 16;
+        r = levels[i / 36];
+        g = levels[(i / 6) % 6];
+        b = levels[i % 6];
+    } else {
+        r = g = b = 8 + (index - 232) * 10;
+    }
+    return QString("#%1%2%3")
+        .arg(r, 2, 16, QLatin1Char('0'))
+        .arg(g, 2, 16, QLatin1Char('0'))
+        .arg(b, 2, 16, QLatin1Char('0'));
+}
+
+// 24 位真彩色近似到 256 色立方
+int nearestCubeIndex(int r, int g, int b) {
+    auto level = [](int v) { return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40; };
+    return 16 + 36 * level(qBound(0, r, 255)) + 6 * level(qBound(0, g, 255)) + level(qBound(0, b, 255));
+}
+
+// 从 ESC 开始的序列是否已经完整
+bool sequenceComplete(QByteArrayView seq) {
+    if (seq.size() < 2) return false;
+    if (seq[1] == '[') {
+        for (qsizetype i = 2; i < seq.size(); ++i) {
+            if (seq[i] >= 0x40 && seq[i] <= 0x7e) return true;
+        }
+        return false;
+    }
+    if (seq[1] == ']') {
+        for (qsizetype i = 2; i < seq.size(); ++i) {
+            if (seq[i] == '\x07') return true;
+            if (seq[i] == Esc && i + 1 < seq.size()) return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+// 把一段完整的输出拆成文本片段和 SGR 参数；其他控制序列直接跳过，末尾不完整的序列丢弃
+template <typename TextFn, typename SgrFn>
+void scan(QByteArrayView data, TextFn onText, SgrFn onSgr) {
+    qsizetype pos = 0;
+    const qsizetype n = data.size();
+    while (pos < n) {
+        qsizetype esc = data.indexOf(Esc, pos);
+        if (esc < 0) {
+            onText(data.sliced(pos));
+            return;
+        }
+        if (esc > pos) onText(data.sliced(pos, esc - pos));
+
+        qsizetype i = esc + 1;
+        if (i >= n) return;
+        if (data[i] == '[') {
+            qsizetype paramsStart = ++i;
+            while (i < n && !(data[i] >= 0x40 && data[i] <= 0x7e)) ++i;
+            if (i >= n) return;
+            if (data[i] == 'm') onSgr(data.sliced(paramsStart, i - paramsStart));
+            pos = i + 1;
+        } else if (data[i] == ']') {
+            ++i;
+            while (i < n && data[i] != '\x07' && data[i] != Esc) ++i;
+            if (i >= n) return;
+            pos = data[i] == Esc ? i + 2 : i + 1;
+        } else {
+            pos = i + 1;
+        }
+    }
+}
+
+void appendEscaped(QString& html, const QString& text) {
+    html.reserve(html.size() + text.size());
+    for (QChar c : text) {
+        switch (c.unicode()) {
+        case '<': html += QLatin1String("&lt;"); break;
+        case '>': html += QLatin1String("&gt;"); break;
+        case '&': html += QLatin1String("&amp;"); break;
+        // StyledText 会折叠空白，缩进和对齐依赖原样保留的空格
+        case ' ': html += QLatin1String("&nbsp;"); break;
+        case '\t': html += QLatin1String("&nbsp;&nbsp;&nbsp;&nbsp;"); break;
+        case '\r': break;
+        default: html += c; break;
+        }
+    }
+}
+
+void appendSpan(QString& html, const QString& text, const SgrState& state) {
+    if (text.isEmpty()) return;
+
+    // StyledText 不支持背景色：反显时用背景色作为文字颜色，其余情况忽略背景
+    int fg = state.inverse ? state.bg : state.fg;
+    if (fg != SgrState::DefaultColor && state.bold && fg < 8) {
+        fg += 8;   // 与多数终端一致，粗体的基本色显示为亮色
+    }
+    QString color;
+    if (fg != SgrState::DefaultColor) {
+        color = colorName(fg);
+    } else if (state.dim) {
+        color = QString::fromLatin1(BasePalette[8]);
+    }
+
+    if (!color.isEmpty()) html += QLatin1String("<font color=\"") + color + QLatin1String("\">");
+    if (state.bold) html += QLatin1String("<b>");
+    if (state.italic) html += QLatin1String("<i>");
+    if (state.underline) html += QLatin1String("<u>");
+    if (state.strike) html += QLatin1String("<s>");
+    appendEscaped(html, text);
+    if (state.strike) html += QLatin1String("</s>");
+    if (state.underline) html += QLatin1String("</u>");
+    if (state.italic) html += QLatin1String("</i>");
+    if (state.bold) html += QLatin1String("</b>");
+    if (!color.isEmpty()) html += QLatin1String("</font>");
+}
+
+}
+
+void SgrState::apply(QByteArrayView params) {
+    // 解析出全部数值参数，空参数按 0 处理；冒号形式的子参数（38:5:n）与分号同样对待
+    int values[32];
+    int count = 0;
+    int current = 0;
+    for (char c : params) {
+        if (c >= '0' && c <= '9') {
+            current = qMin(current * 10 + (c - '0'), 100000);
+        } else if (c == ';' || c == ':') {
+            if (count < 31) values[count++] = current;
+            current = 0;
+        }
+    }
+    values[count++] = current;
+
+    for (int i = 0; i < count; ++i) {
+        int code = values[i];
+        if (code == 0) {
+            *this = SgrState();
+        } else if (code == 1) {
+            bold = true;
+        } else if (code == 2) {
+            dim = true;
+        } else if (code == 3) {
+            italic = true;
+        } else if (code == 4) {
+            underline = true;
+        } else if (code == 7) {
+            inverse = true;
+        } else if (code == 9) {
+            strike = true;
+        } else if (code == 22) {
+            bold = dim = false;
+        } else if (code == 23) {
+            italic = false;
+        } else if (code == 24) {
+            underline = false;
+        } else if (code == 27) {
+            inverse = false;
+        } else if (code == 29) {
+            strike = false;
+        } else if (code >= 30 && code <= 37) {
+            fg = code - 30;
+        } else if (code == 39) {
+            fg = DefaultColor;
+        } else if (code >= 40 && code <= 47) {
+            bg = code - 40;
+        } else if (code == 49) {
+            bg = DefaultColor;
+        } else if (code >= 90 && code <= 97) {
+            fg = code - 90 + 8;
+        } else if (code >= 100 && code <= 107) {
+            bg = code - 100 + 8;
+        } else if (code == 38 || code == 48) {
+            // 扩展颜色：5;n 为 256 色索引，2;r;g;b 为真彩色
+            int color = -1;
+            if (i + 2 < count && values[i + 1] == 5) {
+                color = qBound(0, values[i + 2], 255);
+                i += 2;
+            } else if (i + 4 < count && values[i + 1] == 2) {
+                color = nearestCubeIndex(values[i + 2], values[i + 3], values[i + 4]);
+                i += 4;
+            } else {
+                break;   // 参数不完整，忽略剩余部分
+            }
+            (code == 38 ? fg : bg) = color;
+        }
+    }
+}
+
+quint32 SgrState::pack() const {
+    // 低 9 位前景色，其后 9 位背景色，再往上是字体标志
+    return quint32(fg) | (quint32(bg) << 9)
+        | (quint32(bold) << 18) | (quint32(dim) << 19) | (quint32(italic) << 20)
+        | (quint32(underline) << 21) | (quint32(inverse) << 22) | (quint32(strike) << 23);
+}
+
+SgrState SgrState::unpack(quint32 bits) {
+    SgrState state;
+    state.fg = int(bits & 0x1FF);
+    state.bg = int((bits >> 9) & 0x1FF);
+    state.bold = bits & (1u << 18);
+    state.dim = bits & (1u << 19);
+    state.italic = bits & (1u << 20);
+    state.underline = bits & (1u << 21);
+    state.inverse = bits & (1u << 22);
+    state.strike = bits & (1u << 23);
+    return state;
+}
+
+void SgrParser::feed(QByteArrayView data) {
+    qsizetype i = 0;
+    const qsizetype n = data.size();
+    while (i < n) {
+        switch (m_mode) {
+        case Mode::Text: {
+            // 普通文本只需要找下一个 ESC
+            qsizetype esc = data.indexOf(Esc, i);
+            if (esc < 0) return;
+            m_mode = Mode::Escape;
+            i = esc + 1;
+            break;
+        }
+        case Mode::Escape: {
+            char c = data[i++];
+            if (c == '[') {
+                m_mode = Mode::Csi;
+                m_params.clear();
+            } else if (c == ']') {
+                m_mode = Mode::Osc;
+            } else {
+                m_mode = Mode::Text;   // 其他两字节序列
+            }
+            break;
+        }
+        case Mode::Csi: {
+            char c = data[i++];
+            if (c >= 0x40 && c <= 0x7e) {
+                if (c == 'm') m_state.apply(m_params);
+                m_mode = Mode::Text;
+            } else if (m_params.size() < MaxParams) {
+                m_params.append(c);
+            }
+            break;
+        }
+        case Mode::Osc: {
+            char c = data[i++];
+            if (c == '\x07') m_mode = Mode::Text;
+            else if (c == Esc) m_mode = Mode::OscEscape;
+            break;
+        }
+        case Mode::OscEscape:
+            ++i;   // ST 的第二个字节
+            m_mode = Mode::Text;
+            break;
+        }
+    }
+}
+
+QString decode(QByteArrayView bytes) {
+#ifdef Q_OS_WIN
+    return QString::fromLocal8Bit(bytes);
+#else
+    return QString::fromUtf8(bytes);
+#endif
+}
+
+QString plainText(QByteArrayView bytes) {
+    if (!bytes.contains(Esc)) {
+        return decode(bytes);
+    }
+    // 转义序列都是 ASCII，按 ESC 切开的片段不会截断多字节字符，可以分别解码
+    QString text;
+    text.reserve(bytes.size());
+    scan(bytes, [&](QByteArrayView piece) { text += decode(piece); }, [](QByteArrayView) {});
+    return text;
+}
+
+QString stripped(QStringView text) {
+    QString result;
+    result.reserve(text.size());
+    const qsizetype n = text.size();
+    qsizetype pos = 0;
+    while (pos < n) {
+        qsizetype esc = text.indexOf(QChar(Esc), pos);
+        if (esc < 0) {
+            result += text.sliced(pos);
+            break;
+        }
+        result += text.sliced(pos, esc - pos);
+
+        qsizetype i = esc + 1;
+        if (i >= n) break;
+        if (text[i] == u'[') {
+            ++i;
+            while (i < n && !(text[i].unicode() >= 0x40 && text[i].unicode() <= 0x7e)) ++i;
+            pos = i + 1;
+        } else if (text[i] == u']') {
+            ++i;
+            while (i < n && text[i] != u'\x07' && text[i] != QChar(Esc)) ++i;
+            pos = i < n && text[i] == QChar(Esc) ? i + 2 : i + 1;
+        } else {
+            pos = i + 1;
+        }
+    }
+    return result;
+}
+
+QString styledText(QByteArrayView line, quint32 initialStyle) {
+    SgrState state = SgrState::unpack(initialStyle);
+    if (!line.contains(Esc) && state.isDefault()) {
+        return QString();
+    }
+    QString html;
+    scan(line,
+         [&](QByteArrayView piece) { appendSpan(html, decode(piece), state); },
+         [&](QByteArrayView params) { state.apply(params); });
+    return html;
+}
+
+qsizetype incompleteTail(QByteArrayView bytes) {
+    qsizetype window = qMin(bytes.size(), MaxSequenceLength);
+    QByteArrayView tail = bytes.last(window);
+    qsizetype esc = tail.lastIndexOf(Esc);
+    // ST（ESC \）中的 ESC 也可能是最后一个，向前再找一次
+    if (esc > 0 && esc + 1 < tail.size() && tail[esc + 1] == '\\') {
+        qsizetype previous = tail.first(esc).lastIndexOf(Esc);
+        if (previous >= 0 && !sequenceComplete(tail.sliced(previous))) return window - previous;
+        return 0;
+    }
+    if (esc >= 0 && !sequenceComplete(tail.sliced(esc))) {
+        return window - esc;
+    }
+
+#ifndef Q_OS_WIN
+    // 末尾不完整的 UTF-8 多字节字符
+    for (qsizetype back = 1; back <= qMin<qsizetype>(3, bytes.size()); ++back) {
+        uchar c = uchar(bytes[bytes.size() - back]);
+        if ((c & 0xC0) == 0x80) continue;   // 后续字节，继续向前找起始字节
+        int need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        return need > back ? back : 0;
+    }
+#endif
+    return 0;
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+// 终端输出中的 ANSI 转义序列。SGR（颜色和字体样式）被解析为样式，
+// 光标移动、清屏、OSC 等其他控制序列只剥离不解释。
+namespace Ansi {
+
+// 当前文字样式，前景色/背景色为 256 色调色板索引，打包成一个 quint32 随行保存
+struct SgrState {
+    static constexpr int DefaultColor = 256;
+
+    int fg = DefaultColor;
+    int bg = DefaultColor;
+    bool bold = false;
+    bool dim = false;
+    bool italic = false;
+    bool underline = false;
+    bool inverse = false;
+    bool strike = false;
+
+    bool isDefault() const { return pack() == SgrState().pack(); }
+    void apply(QByteArrayView params);   // 例如 "1;31"、"38;5;208"
+    quint32 pack() const;
+    static SgrState unpack(quint32 bits);
+};
+
+// 增量解析：转义序列被读取边界切开时，未结束的部分保留到下一次 feed
+class SgrParser {
+public:
+    void feed(QByteArrayView data);
+    quint32 style() const { return m_state.pack(); }
+
+private:
+    enum class Mode { Text, Escape, Csi, Osc, OscEscape };
+    static constexpr qsizetype MaxParams = 64;
+
+    Mode m_mode = Mode::Text;
+    QByteArray m_params;
+    SgrState m_state;
+};
+
+// 按平台编码解码（Windows 为本地 8 位编码，其他平台为 UTF-8）
+QString decode(QByteArrayView bytes);
+// 解码并去掉所有转义序列
+QString plainText(QByteArrayView bytes);
+// 去掉已解码文本中的转义序列，末尾不完整的序列一并去掉
+QString stripped(QStringView text);
+// 解码为 QML StyledText；不含转义序列且初始样式为默认时返回空字符串，调用方可直接使用纯文本
+QString styledText(QByteArrayView line, quint32 initialStyle);
+// 末尾尚未结束的转义序列或多字节字符的长度，增量读取时这部分留到下一次
+qsizetype incompleteTail(QByteArrayView bytes);
+
+}
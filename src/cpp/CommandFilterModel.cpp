@@ -0,0 +1,105 @@
+#include "CommandFilterModel.h"
+#include "CommandListModel.h"
+#include "Tracing.h"
+
+CommandFilterModel::CommandFilterModel(CommandListModel* source, QObject* parent)
+    : QSortFilterProxyModel(parent), m_source(source) {
+    setSourceModel(source);
+    setDynamicSortFilter(true);
+    sort(0);
+
+    // 源模型行号变化时得分缓存失效
+    auto clearScores = [this]() { m_scores.clear(); };
+    connect(source, &QAbstractItemModel::rowsAboutToBeInserted, this, clearScores);
+    connect(source, &QAbstractItemModel::rowsAboutToBeRemoved, this, clearScores);
+    // 状态和资源占用的更新不影响匹配得分，只有名称或命令变化时才清空
+    connect(source, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex&, const QModelIndex&, const QList<int>& roles) {
+                if (roles.isEmpty() || roles.contains(CommandListModel::NameRole) ||
+                    roles.contains(CommandListModel::CommandRole)) {
+                    m_scores.clear();
+                }
+            });
+    connect(source, &QAbstractItemModel::modelAboutToBeReset, this, clearScores);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &CommandFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &CommandFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &CommandFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &CommandFilterModel::countChanged);
+}
+
+void CommandFilterModel::setFilterText(const QString& text) {
+    if (m_filterText == text) return;
+    m_filterText = text;
+
+    m_pattern.clear();
+    for (QChar ch : text.toLower()) {
+        if (!ch.isSpace()) m_pattern.append(ch);
+    }
+    m_patternMask = CommandSearchKey::charMask(m_pattern);
+    m_scores.clear();
+
+    TRACE_SCOPE("CommandFilterModel::refilter");
+    invalidate();
+    emit filterTextChanged();
+    emit countChanged();
+}
+
+int CommandFilterModel::fuzzyScore(QStringView pattern, QStringView text) {
+    if (pattern.isEmpty()) return 0;
+
+    int score = 0;
+    qsizetype prev = -2;
+    qsizetype ti = 0;
+    for (QChar pc : pattern) {
+        while (ti < text.size() && text[ti] != pc) ++ti;
+        if (ti >= text.size()) return -1;
+
+        score += 1;
+        if (ti == prev + 1) {
+            score += 5;   // 连续匹配
+        }
+        if (ti == 0 || QStringView(u" -_/.:\\").contains(text[ti - 1])) {
+            score += 8;   // 单词开头
+        }
+        if (prev >= 0) {
+            score -= int(qMin<qsizetype>(ti - prev - 1, 3));   // 间隔惩罚
+        }
+        prev = ti;
+        ++ti;
+    }
+    return score;
+}
+
+int CommandFilterModel::score(int sourceRow) const {
+    auto it = m_scores.constFind(sourceRow);
+    if (it != m_scores.constEnd()) return it.value();
+
+    const CommandSearchKey key = m_source->searchKey(sourceRow);
+    int result = -1;
+    // 先用字符位图快速排除不可能匹配的行
+    if ((key.mask & m_patternMask) == m_patternMask) {
+        int nameScore = fuzzyScore(m_pattern, key.name);
+        int commandScore = fuzzyScore(m_pattern, key.command);
+        // 名称匹配比命令内容匹配更重要
+        result = qMax(nameScore >= 0 ? nameScore * 2 + 10 : -1, commandScore);
+    }
+    m_scores.insert(sourceRow, result);
+    return result;
+}
+
+bool CommandFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    Q_UNUSED(sourceParent)
+    if (m_pattern.isEmpty()) return true;
+    return score(sourceRow) >= 0;
+}
+
+bool CommandFilterModel::lessThan(const QModelIndex& left, const QModelIndex& right) const {
+    if (!m_pattern.isEmpty()) {
+        int l = score(left.row());
+        int r = score(right.row());
+        if (l != r) return l > r;
+    }
+    // 没有搜索词或得分相同时保持原有顺序
+    return left.row() < right.row();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include <QHash>
+
+class CommandListModel;
+
+// 命令列表的模糊搜索过滤：同时匹配名称和命令内容，按匹配得分排序
+class CommandFilterModel : public QSortFilterProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit CommandFilterModel(CommandListModel* source, QObject* parent = nullptr);
+
+    QString filterText() const { return m_filterText; }
+    void setFilterText(const QString& text);
+    int count() const { return rowCount(); }
+
+    // 子序列模糊匹配得分，未匹配返回 -1
+    static int fuzzyScore(QStringView pattern, QStringView text);
+
+signals:
+    void filterTextChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    int score(int sourceRow) const;
+
+    CommandListModel* m_source;
+    QString m_filterText;
+    QString m_pattern;       // 小写化、去掉空白后的搜索词
+    quint64 m_patternMask = 0;
+    mutable QHash<int, int> m_scores;   // 当前搜索词下各源行的得分缓存
+};
@@ -0,0 +1,50 @@
+#include "CommandLine.h"
+#include <QProcess>
+
+namespace CommandLine {
+
+bool needsShell(const QString& command) {
+    // 分词使用 QProcess::splitCommand，它只识别双引号，含单引号的命令交给 shell
+    bool inDouble = false;
+    for (qsizetype i = 0; i < command.size(); ++i) {
+        QChar ch = command.at(i);
+        if (ch == u'\'') return true;
+        if (ch == u'"') {
+            inDouble = !inDouble;
+            continue;
+        }
+#ifdef Q_OS_WIN
+        // cmd.exe 的变量展开和转义符；反斜杠是路径分隔符，不是特殊字符
+        if (ch == u'%' || ch == u'^') return true;
+#else
+        // 双引号内 shell 仍会展开变量和命令替换
+        if (ch == u'$' || ch == u'`' || ch == u'\\') return true;
+#endif
+        if (inDouble) continue;
+
+        switch (ch.unicode()) {
+        case '|': case '&': case ';': case '<': case '>':
+        case '(': case ')': case '*': case '?': case '[':
+        case '{': case '}': case '#': case '\n':
+            return true;
+        case '~':
+            // 只有词首的 ~ 会被展开为家目录
+            if (i == 0 || command.at(i - 1).isSpace()) return true;
+            break;
+        case '=':
+            // 第一个词中的 VAR=value 是环境变量赋值
+            if (!command.left(i).contains(u' ')) return true;
+            break;
+        default:
+            break;
+        }
+    }
+    return inDouble;
+}
+
+QStringList directArgv(const QString& command) {
+    if (needsShell(command)) return QStringList();
+    return QProcess::splitCommand(command);
+}
+
+}
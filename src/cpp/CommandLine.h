@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// 命令的启动方式：经 shell 解释，或分词后直接执行程序
+enum class LaunchMode {
+    Shell = 0,
+    Direct = 1
+};
+
+namespace CommandLine {
+
+// 命令中含有管道、重定向、变量、通配符等只有 shell 才能解释的语法
+bool needsShell(const QString& command);
+
+// 按引号规则分词，得到可直接执行的 argv；需要 shell 时返回空列表
+QStringList directArgv(const QString& command);
+
+}
@@ -0,0 +1,271 @@
+#include "CommandListModel.h"
+#include "CommandManager.h"
+#include "Tracing.h"
+
+quint64 CommandSearchKey::charMask(QStringView text) {
+    // a-z 占 0-25 位，0-9 占 26-35 位，其余字符归入第 36 位
+    quint64 mask = 0;
+    for (QChar ch : text) {
+        char16_t c = ch.unicode();
+        if (c >= 'a' && c <= 'z') {
+            mask |= quint64(1) << (c - 'a');
+        } else if (c >= '0' && c <= '9') {
+            mask |= quint64(1) << (26 + c - '0');
+        } else if (c != ' ') {
+            mask |= quint64(1) << 36;
+        }
+    }
+    return mask;
+}
+
+CommandListModel::CommandListModel(QObject* parent)
+    : QAbstractListModel(parent) {}
+
+int CommandListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : int(m_records.size());
+}
+
+QVariant CommandListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_records.size()) {
+        return QVariant();
+    }
+
+    const CommandRecord& record = m_records.at(index.row());
+    CommandEntry* entry = record.entry;
+    switch (role) {
+    case CommandObjectRole:
+        return QVariant::fromValue<QObject*>(entry);
+    case Qt::DisplayRole:
+    case NameRole:
+        return record.name;
+    case CommandRole:
+        return record.command;
+    case RunningRole:
+        return entry && entry->isRunning();
+    case StartingRole:
+        return entry && entry->isStarting();
+    case StoppingRole:
+        return entry && entry->isStopping();
+    case CpuRole:
+        return entry ? entry->cpuPercent() : 0.0;
+    case RssRole:
+        return entry ? entry->rssKb() : 0;
+    case RssHistoryRole:
+        return entry ? QVariant::fromValue(entry->rssHistory()) : QVariant();
+    case LaunchModeRole:
+        return int(record.launchMode);
+    case RestartPolicyRole:
+        return int(record.restartPolicy);
+    case RestartCountRole:
+        return entry ? entry->restartCount() : 0;
+    case RestartPendingRole:
+        return entry && entry->restartPending();
+    case RestartParkedRole:
+        return entry && entry->restartParked();
+    case ReadyRole:
+        return entry && entry->isReady();
+    case HighlightCountRole:
+        return entry ? entry->highlightCount() : 0;
+    case TeePathRole:
+        return record.teePath;
+    case TeeRateRole:
+        return entry ? entry->teeRate() : 0.0;
+    case IdRole:
+        return record.id;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> CommandListModel::roleNames() const {
+    return {
+        { CommandObjectRole, "cmd" },
+        { NameRole, "name" },
+        { CommandRole, "command" },
+        { RunningRole, "isRunning" },
+        { StartingRole, "isStarting" },
+        { StoppingRole, "isStopping" },
+        { CpuRole, "cpuPercent" },
+        { RssRole, "rssKb" },
+        { RssHistoryRole, "rssHistory" },
+        { LaunchModeRole, "launchMode" },
+        { RestartPolicyRole, "restartPolicy" },
+        { RestartCountRole, "restartCount" },
+        { RestartPendingRole, "restartPending" },
+        { RestartParkedRole, "restartParked" },
+        { ReadyRole, "isReady" },
+        { HighlightCountRole, "highlightCount" },
+        { TeePathRole, "teePath" },
+        { TeeRateRole, "teeRate" },
+        { IdRole, "commandId" }
+    };
+}
+
+void CommandListModel::append(const CommandRecord& record) {
+    appendRecords({ record });
+}
+
+void CommandListModel::appendRecords(const QList<CommandRecord>& records) {
+    if (records.isEmpty()) return;
+    TRACE_SCOPE("CommandListModel::appendRecords");
+
+    int first = int(m_records.size());
+    beginInsertRows(QModelIndex(), first, first + int(records.size()) - 1);
+    for (CommandRecord record : records) {
+        record.searchKey = makeSearchKey(record.name, record.command);
+        m_rowByName.insert(record.name, int(m_records.size()));
+        m_rowById.insert(record.id, int(m_records.size()));
+        m_records.append(record);
+        if (record.entry) {
+            watch(record.entry);
+        }
+    }
+    endInsertRows();
+    emit countChanged();
+}
+
+void CommandListModel::remove(qint64 id) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    const CommandRecord& record = m_records.at(row);
+    if (record.entry) {
+        disconnect(record.entry, nullptr, this, nullptr);
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rowByName.remove(record.name);
+    m_rowById.remove(id);
+    m_records.removeAt(row);
+    reindexFrom(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void CommandListModel::update(qint64 id, const QString& newName, const QString& newCommand) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    CommandRecord& record = m_records[row];
+    QList<int> roles;
+    if (record.name != newName) {
+        m_rowByName.remove(record.name);
+        m_rowByName.insert(newName, row);
+        record.name = newName;
+        roles.append(NameRole);
+        roles.append(Qt::DisplayRole);
+    }
+    if (record.command != newCommand) {
+        record.command = newCommand;
+        roles.append(CommandRole);
+    }
+    if (roles.isEmpty()) return;
+    record.searchKey = makeSearchKey(newName, newCommand);
+    emit dataChanged(index(row), index(row), roles);
+}
+
+void CommandListModel::attach(qint64 id, CommandEntry* entry) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    CommandRecord& record = m_records[row];
+    if (record.entry == entry) return;
+    if (record.entry) {
+        disconnect(record.entry, nullptr, this, nullptr);
+    }
+    record.entry = entry;
+    if (entry) {
+        watch(entry);
+    }
+    emit dataChanged(index(row), index(row));
+}
+
+void CommandListModel::setLaunch(qint64 id, LaunchMode mode, const QStringList& argv) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    m_records[row].launchMode = mode;
+    m_records[row].argv = argv;
+    emit dataChanged(index(row), index(row), { LaunchModeRole });
+}
+
+void CommandListModel::setRestartPolicy(qint64 id, RestartPolicy policy) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    m_records[row].restartPolicy = policy;
+    emit dataChanged(index(row), index(row), { RestartPolicyRole });
+}
+
+void CommandListModel::setTee(qint64 id, const QString& path, qint64 rotateBytes) {
+    int row = rowOf(id);
+    if (row < 0) return;
+
+    m_records[row].teePath = path;
+    m_records[row].teeRotateBytes = rotateBytes;
+    emit dataChanged(index(row), index(row), { TeePathRole });
+}
+
+qint64 CommandListModel::idOf(const QString& name) const {
+    const CommandRecord* found = record(name);
+    return found ? found->id : 0;
+}
+
+QStringList CommandListModel::names() const {
+    QStringList names;
+    names.reserve(m_records.size());
+    for (const CommandRecord& record : m_records) {
+        names.append(record.name);
+    }
+    return names;
+}
+
+void CommandListModel::watch(CommandEntry* entry) {
+    connect(entry, &CommandEntry::runningChanged, this, [this, entry]() {
+        notifyChanged(entry, { RunningRole });
+    });
+    connect(entry, &CommandEntry::startingChanged, this, [this, entry]() {
+        notifyChanged(entry, { StartingRole });
+    });
+    connect(entry, &CommandEntry::stoppingChanged, this, [this, entry]() {
+        notifyChanged(entry, { StoppingRole });
+    });
+    connect(entry, &CommandEntry::restartStateChanged, this, [this, entry]() {
+        notifyChanged(entry, { RestartCountRole, RestartPendingRole, RestartParkedRole });
+    });
+    connect(entry, &CommandEntry::metricsChanged, this, [this, entry]() {
+        notifyChanged(entry, { CpuRole, RssRole, RssHistoryRole });
+    });
+    connect(entry, &CommandEntry::readyChanged, this, [this, entry]() {
+        notifyChanged(entry, { ReadyRole });
+    });
+    connect(entry, &CommandEntry::patternStateChanged, this, [this, entry]() {
+        notifyChanged(entry, { HighlightCountRole });
+    });
+    connect(entry, &CommandEntry::teeChanged, this, [this, entry]() {
+        notifyChanged(entry, { TeeRateRole });
+    });
+}
+
+void CommandListModel::notifyChanged(CommandEntry* entry, const QList<int>& roles) {
+    TRACE_SCOPE("CommandListModel::notifyChanged");
+    int row = rowOf(entry->id());
+    if (row >= 0 && m_records.at(row).entry == entry) {
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+void CommandListModel::reindexFrom(int row) {
+    for (int i = row; i < m_records.size(); ++i) {
+        const CommandRecord& record = m_records.at(i);
+        m_rowByName[record.name] = i;
+        m_rowById[record.id] = i;
+    }
+}
+
+CommandSearchKey CommandListModel::makeSearchKey(const QString& name, const QString& command) {
+    CommandSearchKey key;
+    key.name = name.toLower();
+    key.command = command.toLower();
+    key.mask = CommandSearchKey::charMask(key.name) | CommandSearchKey::charMask(key.command);
+    return key;
+}
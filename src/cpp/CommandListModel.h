@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QHash>
+#include <QStringList>
+#include "CommandLine.h"
+#include "RestartSupervisor.h"
+
+class CommandEntry;
+
+// 搜索索引项：小写化的名称/命令文本及其字符位图，随增删改增量维护
+struct CommandSearchKey {
+    QString name;
+    QString command;
+    quint64 mask = 0;
+
+    static quint64 charMask(QStringView text);
+};
+
+// 轻量的命令行记录，只有在命令被运行或查看输出时才创建对应的 CommandEntry
+struct CommandRecord {
+    qint64 id = 0;
+    QString name;
+    QString command;
+    CommandEntry* entry = nullptr;
+    CommandSearchKey searchKey;
+    LaunchMode launchMode = LaunchMode::Shell;
+    QStringList argv;   // 直接启动模式下保存时分好的参数
+    RestartPolicy restartPolicy = RestartPolicy::Never;
+    QString teePath;             // 为空表示不转发
+    qint64 teeRotateBytes = 0;   // 0 表示不轮转
+};
+
+// 命令列表模型：增删改时只发出对应行的细粒度通知，界面不再整体重建
+class CommandListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        CommandObjectRole = Qt::UserRole + 1,
+        NameRole,
+        CommandRole,
+        RunningRole,
+        StartingRole,
+        StoppingRole,
+        CpuRole,
+        RssRole,
+        RssHistoryRole,
+        LaunchModeRole,
+        RestartPolicyRole,
+        RestartCountRole,
+        RestartPendingRole,
+        RestartParkedRole,
+        ReadyRole,
+        HighlightCountRole,
+        TeePathRole,
+        TeeRateRole,
+        IdRole
+    };
+
+    explicit CommandListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void append(const CommandRecord& record);
+    void appendRecords(const QList<CommandRecord>& records);   // 分页加载时批量追加
+    // 修改按 id 定位行，只通知实际变化的角色
+    void remove(qint64 id);
+    void update(qint64 id, const QString& newName, const QString& newCommand);
+    void attach(qint64 id, CommandEntry* entry);                // 关联已创建的 CommandEntry
+    void setLaunch(qint64 id, LaunchMode mode, const QStringList& argv);
+    void setRestartPolicy(qint64 id, RestartPolicy policy);
+    void setTee(qint64 id, const QString& path, qint64 rotateBytes);
+
+    bool contains(const QString& name) const { return m_rowByName.contains(name); }
+    bool contains(qint64 id) const { return m_rowById.contains(id); }
+    int rowOf(const QString& name) const { return m_rowByName.value(name, -1); }
+    int rowOf(qint64 id) const { return m_rowById.value(id, -1); }
+    qint64 idOf(const QString& name) const;                     // 不存在时返回 0
+    const CommandRecord* record(const QString& name) const { return recordAt(rowOf(name)); }
+    const CommandRecord* record(qint64 id) const { return recordAt(rowOf(id)); }
+    QStringList names() const;                                  // 按列表顺序
+    CommandSearchKey searchKey(int row) const { return m_records.value(row).searchKey; }
+
+signals:
+    void countChanged();
+
+private:
+    void watch(CommandEntry* entry);
+    void notifyChanged(CommandEntry* entry, const QList<int>& roles);
+    const CommandRecord* recordAt(int row) const { return row < 0 ? nullptr : &m_records.at(row); }
+    void reindexFrom(int row);
+    static CommandSearchKey makeSearchKey(const QString& name, const QString& command);
+
+    QList<CommandRecord> m_records;
+    QHash<QString, int> m_rowByName;   // 名称 -> 行号
+    QHash<qint64, int> m_rowById;      // id -> 行号，改名时不变
+};
@@ -0,0 +1,52 @@
+#include "ControlClient.h"
+#include "ControlServer.h"
+#include <QLocalSocket>
+#include <cstdio>
+
+namespace ControlClient {
+
+int run(const QString& serverName, const QStringList& request) {
+    if (request.isEmpty()) {
+        std::fprintf(stderr, "usage: --ctl start|stop|status|tail|untail|shutdown [name] [lines]\n");
+        return 2;
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(3000)) {
+        std::fprintf(stderr, "cannot connect to %s: %s\n",
+                     qPrintable(serverName), qPrintable(socket.errorString()));
+        return 2;
+    }
+    socket.write(ControlServer::encode(request));
+    socket.flush();
+
+    // tail 在 ok 之后继续接收推送，直到命令结束或服务端断开
+    bool following = request.first() == "tail";
+    for (;;) {
+        while (socket.canReadLine()) {
+            const QStringList fields = ControlServer::decode(socket.readLine());
+            const QString& kind = fields.first();
+            if (kind == "out") {
+                QByteArray text = fields.value(2).toLocal8Bit();
+                std::fwrite(text.constData(), 1, size_t(text.size()), stdout);
+                std::fflush(stdout);
+            } else if (kind == "status") {
+                std::printf("%s\n", qPrintable(fields.mid(1).join('\t')));
+            } else if (kind == "gap") {
+                std::fprintf(stderr, "[output skipped]\n");
+            } else if (kind == "exit") {
+                return fields.value(3).toInt() == 0 ? fields.value(2).toInt() : 1;
+            } else if (kind == "err") {
+                std::fprintf(stderr, "error: %s\n", qPrintable(fields.value(1)));
+                return 1;
+            } else if (kind == "ok" && !following) {
+                return 0;
+            }
+        }
+        if (!socket.waitForReadyRead(-1)) break;   // 服务端断开
+    }
+    return following ? 1 : 0;
+}
+
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// 控制接口的命令行客户端：appRCmdLaunch --ctl <request> [args...]
+// 发送一个请求并把应答写到标准输出；tail 会一直输出到命令结束，并以命令的退出码退出
+namespace ControlClient {
+int run(const QString& serverName, const QStringList& request);
+}
@@ -0,0 +1,276 @@
+#include "ControlServer.h"
+#include "CommandManager.h"
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace {
+constexpr qint64 MaxRequestLength = 64 * 1024;   // 超过仍未遇到换行的请求视为无效并断开
+}
+
+ControlServer::ControlServer(CommandManager* manager, QObject* parent)
+    : QObject(parent), m_manager(manager), m_server(new QLocalServer(this)) {
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::handleConnection);
+    connect(m_manager, &CommandManager::outputUpdated, this, &ControlServer::handleOutputUpdated);
+    connect(m_manager, &CommandManager::commandFinished, this, &ControlServer::handleCommandFinished);
+}
+
+QString ControlServer::defaultServerName() {
+    // 按用户区分，同一台机器上的多个用户各自有独立的控制接口
+    QString user = qEnvironmentVariable("USER", qEnvironmentVariable("USERNAME"));
+    return user.isEmpty() ? QString("RCmdLaunch") : QString("RCmdLaunch-%1").arg(user);
+}
+
+bool ControlServer::listen(const QString& name) {
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (m_server->listen(name)) {
+        qDebug() << "Control server listening on:" << m_server->fullServerName();
+        return true;
+    }
+
+    // 上次异常退出可能留下了套接字文件；确认没有实例在监听后再清理重试
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (!probe.waitForConnected(500)) {
+            QLocalServer::removeServer(name);
+            if (m_server->listen(name)) {
+                qDebug() << "Control server listening on:" << m_server->fullServerName();
+                return true;
+            }
+        }
+    }
+    qWarning() << "Failed to start control server:" << name << m_server->errorString();
+    return false;
+}
+
+QByteArray ControlServer::encode(const QStringList& fields) {
+    QString line;
+    for (int i = 0; i < fields.size(); ++i) {
+        if (i > 0) line += QLatin1Char('\t');
+        for (QChar c : fields.at(i)) {
+            switch (c.unicode()) {
+            case '\\': line += QLatin1String("\\\\"); break;
+            case '\t': line += QLatin1String("\\t"); break;
+            case '\n': line += QLatin1String("\\n"); break;
+            case '\r': line += QLatin1String("\\r"); break;
+            default: line += c; break;
+            }
+        }
+    }
+    line += QLatin1Char('\n');
+    return line.toUtf8();
+}
+
+QStringList ControlServer::decode(QByteArrayView line) {
+    QString text = QString::fromUtf8(line);
+    if (text.endsWith(QLatin1Char('\n'))) text.chop(1);
+    if (text.endsWith(QLatin1Char('\r'))) text.chop(1);
+
+    QStringList fields;
+    QString field;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        QChar c = text.at(i);
+        if (c == QLatin1Char('\t')) {
+            fields.append(field);
+            field.clear();
+        } else if (c == QLatin1Char('\\') && i + 1 < text.size()) {
+            QChar next = text.at(++i);
+            field += next == QLatin1Char('t') ? QChar('\t')
+                   : next == QLatin1Char('n') ? QChar('\n')
+                   : next == QLatin1Char('r') ? QChar('\r') : next;
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+void ControlServer::handleConnection() {
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { handleReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            const Client client = m_clients.take(socket);
+            for (auto it = client.tails.cbegin(); it != client.tails.cend(); ++it) {
+                if (--m_tailers[it.key()] <= 0) {
+                    m_tailers.remove(it.key());
+                }
+            }
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::handleReadyRead(QLocalSocket* socket) {
+    while (socket->canReadLine()) {
+        QStringList request = decode(socket->readLine());
+        if (!request.isEmpty() && !request.first().isEmpty()) {
+            handleRequest(socket, request);
+        }
+    }
+    if (socket->bytesAvailable() > MaxRequestLength) {
+        qWarning() << "Control request too long, disconnecting client";
+        socket->disconnectFromServer();
+    }
+}
+
+void ControlServer::handleRequest(QLocalSocket* socket, const QStringList& request) {
+    const QString& verb = request.first();
+    const QString name = request.value(1);
+    bool known = !name.isEmpty() && !m_manager->getCommandContent(name).isEmpty();
+
+    if (verb == "status") {
+        if (name.isEmpty()) {
+            const QStringList names = m_manager->commandNames();
+            for (const QString& n : names) {
+                sendStatus(socket, n);
+            }
+        } else if (known) {
+            sendStatus(socket, name);
+        } else {
+            send(socket, { "err", "unknown command" });
+            return;
+        }
+        send(socket, { "ok" });
+        return;
+    }
+    if (verb == "shutdown") {
+        if (!m_shutdownAllowed) {
+            send(socket, { "err", "shutdown is only available in headless mode" });
+            return;
+        }
+        send(socket, { "ok" });
+        socket->flush();
+        emit shutdownRequested();
+        return;
+    }
+    if (verb == "untail") {
+        Client& client = m_clients[socket];
+        if (client.tails.remove(name) && --m_tailers[name] <= 0) {
+            m_tailers.remove(name);
+        }
+        send(socket, { "ok" });
+        return;
+    }
+
+    if (verb != "start" && verb != "stop" && verb != "tail") {
+        send(socket, { "err", "unknown request" });
+        return;
+    }
+    if (!known) {
+        send(socket, { "err", "unknown command" });
+        return;
+    }
+
+    if (verb == "start") {
+        m_manager->startCommand(name);
+    } else if (verb == "stop") {
+        m_manager->stopCommand(name);
+    } else {
+        // 没有在运行的命令不会再推送 exit：结束过的命令发送已有输出后立即以最近一次的
+        // 退出信息结束，从未运行过的命令直接报错，客户端都不会一直等待
+        QVariantMap status = m_manager->commandStatus(name);
+        bool active = status.value("state").toString() != "stopped";
+        if (!active && !status.contains("exitCode")) {
+            send(socket, { "err", "command is not running" });
+            return;
+        }
+
+        bool ok = false;
+        int lines = request.value(2).toInt(&ok);
+        startTail(socket, name, ok && lines >= 0 ? lines : DefaultTailLines, active);
+        send(socket, { "ok" });
+        if (!active) {
+            send(socket, { "exit", name, status.value("exitCode").toString(), status.value("exitStatus").toString() });
+        }
+        return;
+    }
+    send(socket, { "ok" });
+}
+
+void ControlServer::startTail(QLocalSocket* socket, const QString& name, int lines, bool follow) {
+    Client& client = m_clients[socket];
+    if (follow && !client.tails.contains(name)) {
+        ++m_tailers[name];
+    }
+
+    // 还没有输出的命令从头开始跟踪；已有输出时只发送最后 lines 行
+    QVariantMap current = m_manager->readOutput(name, -1, true);
+    if (current.isEmpty()) {
+        if (follow) {
+            client.tails.insert(name, 0);
+        }
+        return;
+    }
+
+    QString text = current.value("text").toString();
+    qsizetype from = text.size();
+    qsizetype pos = text.endsWith(QLatin1Char('\n')) ? text.size() - 1 : text.size();
+    for (int i = 0; i < lines && pos > 0; ++i) {
+        qsizetype newline = text.lastIndexOf(QLatin1Char('\n'), pos - 1);
+        from = newline + 1;
+        pos = newline;
+        if (newline < 0) break;
+    }
+    if (from < text.size()) {
+        send(socket, { "out", name, text.mid(from) });
+    }
+    if (follow) {
+        client.tails.insert(name, current.value("end").toLongLong());
+    }
+}
+
+void ControlServer::handleOutputUpdated(const QString& name) {
+    if (!m_tailers.contains(name)) return;
+
+    // 多个客户端通常停在同一位置，同一偏移只读取一次
+    QHash<qint64, QVariantMap> deltas;
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        auto tail = it->tails.find(name);
+        if (tail == it->tails.end()) continue;
+
+        QLocalSocket* socket = it.key();
+        auto delta = deltas.find(*tail);
+        if (delta == deltas.end()) {
+            delta = deltas.insert(*tail, m_manager->readOutput(name, *tail, true));
+        }
+        if (delta->isEmpty()) continue;
+
+        qint64 end = delta->value("end").toLongLong();
+        if (end == *tail && !delta->value("reset").toBool()) continue;
+
+        // 输出被淘汰或清空，或者客户端读取跟不上时，跳过中间内容
+        if (delta->value("reset").toBool() || socket->bytesToWrite() > MaxPendingBytes) {
+            send(socket, { "gap", name });
+            if (socket->bytesToWrite() > MaxPendingBytes) {
+                *tail = end;
+                continue;
+            }
+        }
+        send(socket, { "out", name, delta->value("text").toString() });
+        *tail = end;
+    }
+}
+
+void ControlServer::handleCommandFinished(const QString& name, int exitCode, int exitStatus) {
+    if (!m_tailers.contains(name)) return;
+
+    for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it) {
+        if (it->tails.contains(name)) {
+            send(it.key(), { "exit", name, QString::number(exitCode), QString::number(exitStatus) });
+        }
+    }
+}
+
+void ControlServer::send(QLocalSocket* socket, const QStringList& fields) {
+    socket->write(encode(fields));
+}
+
+void ControlServer::sendStatus(QLocalSocket* socket, const QString& name) {
+    QVariantMap status = m_manager->commandStatus(name);
+    send(socket, { "status", name, status.value("state").toString(),
+                   QString::number(status.value("pid").toLongLong()),
+                   status.value("ready").toBool() ? "1" : "0" });
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+
+class CommandManager;
+class QLocalServer;
+class QLocalSocket;
+
+// 本地控制接口：通过 QLocalServer 让脚本启动、停止、查询命令并实时跟踪输出。
+//
+// 协议按行传输（UTF-8，以 \n 结尾），字段之间用制表符分隔，字段中的
+// 反斜杠、制表符和换行转义为 \\、\t、\n、\r。请求：
+//   start <name>            stop <name>
+//   status [<name>]         每个命令一行 status <name> <state> <pid> <ready>
+//   tail <name> [<lines>]   先发送最后 lines 行，之后持续推送 out <name> <text>（保留 ANSI 颜色），
+//                           进程结束时推送 exit <name> <code> <status>；命令没有在运行时
+//                           在 ok 之后立即发送最近一次运行的 exit，从未运行过则返回 err
+//   untail <name>           shutdown（仅无界面模式下退出程序）
+// 每个请求以 ok 或 err <message> 结束。客户端接收过慢时跳过积压的输出并发送 gap <name>
+class ControlServer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultTailLines = 100;
+    static constexpr qint64 MaxPendingBytes = 4 * 1024 * 1024;   // 单个客户端允许积压的字节数
+
+    explicit ControlServer(CommandManager* manager, QObject* parent = nullptr);
+
+    static QString defaultServerName();
+    bool listen(const QString& name);
+    void setShutdownAllowed(bool allowed) { m_shutdownAllowed = allowed; }
+
+    static QByteArray encode(const QStringList& fields);
+    static QStringList decode(QByteArrayView line);
+
+signals:
+    void shutdownRequested();
+
+private:
+    struct Client {
+        QHash<QString, qint64> tails;   // 正在跟踪的命令 -> 已发送到的输出位置
+    };
+
+    void handleConnection();
+    void handleReadyRead(QLocalSocket* socket);
+    void handleRequest(QLocalSocket* socket, const QStringList& request);
+    void handleOutputUpdated(const QString& name);
+    void handleCommandFinished(const QString& name, int exitCode, int exitStatus);
+    // follow 为 false 时只发送最后 lines 行，不继续跟踪
+    void startTail(QLocalSocket* socket, const QString& name, int lines, bool follow);
+    void send(QLocalSocket* socket, const QStringList& fields);
+    void sendStatus(QLocalSocket* socket, const QString& name);
+
+    CommandManager* m_manager;
+    QLocalServer* m_server;
+    QHash<QLocalSocket*, Client> m_clients;
+    QHash<QString, int> m_tailers;   // 命令 -> 跟踪它的客户端数，没有客户端跟踪时不读取输出
+    bool m_shutdownAllowed = false;
+};
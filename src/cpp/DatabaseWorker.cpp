@@ -0,0 +1,410 @@
+#include "DatabaseWorker.h"
+#include "Tracing.h"
+#include <QDebug>
+#include <QSqlError>
+#include <QFile>
+#include <QFileInfo>
+#include <utility>
+
+DatabaseWorker::DatabaseWorker(QObject* parent)
+    : QObject(parent), m_writeTimer(new QTimer(this)) {
+    m_writeTimer->setSingleShot(true);
+    connect(m_writeTimer, &QTimer::timeout, this, &DatabaseWorker::flush);
+}
+
+bool DatabaseWorker::open(const QString& path) {
+    // 每个线程需要使用自己的连接
+    m_database = QSqlDatabase::addDatabase("QSQLITE", "RCmdLaunchStore");
+    m_database.setDatabaseName(path);
+    
+    if (!m_database.open()) {
+        qWarning() << "Failed to open database:" << m_database.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery query(m_database);
+    if (!query.exec("PRAGMA journal_mode=WAL")) {
+        qWarning() << "Failed to enable WAL:" << query.lastError().text();
+    }
+    query.exec("PRAGMA synchronous=NORMAL");
+    
+    // 创建表
+    QString createTableSQL = R"(
+        CREATE TABLE IF NOT EXISTS commands (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT UNIQUE NOT NULL,
+            command TEXT NOT NULL,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    
+    if (!query.exec(createTableSQL)) {
+        qWarning() << "Failed to create table:" << query.lastError().text();
+        return false;
+    }
+
+    // 旧版本创建的表没有后来增加的列，按需补上
+    if (!ensureColumn("commands", "launch_mode", "INTEGER NOT NULL DEFAULT 0") ||
+        !ensureColumn("commands", "restart_policy", "INTEGER NOT NULL DEFAULT 0") ||
+        !ensureColumn("commands", "tee_path", "TEXT NOT NULL DEFAULT ''") ||
+        !ensureColumn("commands", "tee_rotate_bytes", "INTEGER NOT NULL DEFAULT 0")) {
+        return false;
+    }
+
+    // 命令组及其成员，depends_on 用换行分隔多个依赖
+    QString createGroupsSQL = R"(
+        CREATE TABLE IF NOT EXISTS command_groups (
+            name TEXT PRIMARY KEY,
+            max_concurrency INTEGER NOT NULL DEFAULT 4
+        )
+    )";
+    QString createMembersSQL = R"(
+        CREATE TABLE IF NOT EXISTS group_members (
+            group_name TEXT NOT NULL,
+            command_name TEXT NOT NULL,
+            position INTEGER NOT NULL DEFAULT 0,
+            depends_on TEXT,
+            ready_pattern TEXT,
+            wait_exit INTEGER NOT NULL DEFAULT 0,
+            PRIMARY KEY (group_name, command_name)
+        )
+    )";
+
+    if (!query.exec(createGroupsSQL) || !query.exec(createMembersSQL)) {
+        qWarning() << "Failed to create group tables:" << query.lastError().text();
+        return false;
+    }
+
+    // 运行历史，输出内容保存在 archive 指向的压缩归档文件中
+    QString createRunsSQL = R"(
+        CREATE TABLE IF NOT EXISTS runs (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            command_name TEXT NOT NULL,
+            started_at INTEGER NOT NULL,
+            finished_at INTEGER,
+            duration_ms INTEGER,
+            exit_code INTEGER,
+            exit_status INTEGER,
+            peak_rss_kb INTEGER,
+            output_bytes INTEGER,
+            archive TEXT UNIQUE NOT NULL
+        )
+    )";
+
+    if (!query.exec(createRunsSQL) ||
+        !query.exec("CREATE INDEX IF NOT EXISTS runs_by_command ON runs (command_name, started_at)")) {
+        qWarning() << "Failed to create runs table:" << query.lastError().text();
+        return false;
+    }
+
+    // 输出模式：action 对应 PatternAction（0 就绪，1 高亮，2 通知）
+    QString createPatternsSQL = R"(
+        CREATE TABLE IF NOT EXISTS command_patterns (
+            command_name TEXT NOT NULL,
+            position INTEGER NOT NULL,
+            pattern TEXT NOT NULL,
+            action INTEGER NOT NULL DEFAULT 1,
+            PRIMARY KEY (command_name, position)
+        )
+    )";
+
+    if (!query.exec(createPatternsSQL)) {
+        qWarning() << "Failed to create patterns table:" << query.lastError().text();
+        return false;
+    }
+    
+    qDebug() << "Database initialized successfully at:" << path;
+    return true;
+}
+
+void DatabaseWorker::close() {
+    flush();
+    m_statements.clear();
+    m_database.close();
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase("RCmdLaunchStore");
+}
+
+bool DatabaseWorker::commandExists(const QString& name) {
+    TRACE_SCOPE("DatabaseWorker::commandExists");
+    QSqlQuery& query = statement("SELECT 1 FROM commands WHERE name = ?");
+    query.bindValue(0, name);
+    bool exists = query.exec() && query.next();
+    query.finish();
+    return exists;
+}
+
+qint64 DatabaseWorker::lastCommandId() {
+    // AUTOINCREMENT 的序号在删除后不会回退，显式插入的 id 也会推进它
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT MAX(COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'commands'), 0), "
+                    "COALESCE((SELECT MAX(id) FROM commands), 0))") || !query.next()) {
+        qWarning() << "Failed to read last command id:" << query.lastError().text();
+        return 0;
+    }
+    return query.value(0).toLongLong();
+}
+
+QList<CommandGroup> DatabaseWorker::loadGroups() {
+    TRACE_SCOPE("DatabaseWorker::loadGroups");
+    QList<CommandGroup> groups;
+    QHash<QString, int> indexOf;
+
+    QSqlQuery query("SELECT name, max_concurrency FROM command_groups", m_database);
+    while (query.next()) {
+        CommandGroup g;
+        g.name = query.value(0).toString();
+        g.maxConcurrency = qMax(1, query.value(1).toInt());
+        indexOf.insert(g.name, int(groups.size()));
+        groups.append(g);
+    }
+
+    QSqlQuery members("SELECT group_name, command_name, depends_on, ready_pattern, wait_exit "
+                      "FROM group_members ORDER BY group_name, position", m_database);
+    while (members.next()) {
+        int index = indexOf.value(members.value(0).toString(), -1);
+        if (index < 0) continue;
+
+        GroupMember member;
+        member.command = members.value(1).toString();
+        member.dependsOn = members.value(2).toString().split('\n', Qt::SkipEmptyParts);
+        member.readyPattern = members.value(3).toString();
+        member.waitForExit = members.value(4).toBool();
+        groups[index].members.append(member);
+    }
+
+    if (members.lastError().isValid()) {
+        qWarning() << "Failed to load groups:" << members.lastError().text();
+    }
+    return groups;
+}
+
+QHash<QString, QList<OutputPattern>> DatabaseWorker::loadPatterns() {
+    TRACE_SCOPE("DatabaseWorker::loadPatterns");
+    QHash<QString, QList<OutputPattern>> patterns;
+    QSqlQuery query("SELECT command_name, pattern, action FROM command_patterns "
+                    "ORDER BY command_name, position", m_database);
+    while (query.next()) {
+        OutputPattern pattern;
+        pattern.pattern = query.value(1).toString();
+        pattern.action = PatternAction(qBound(0, query.value(2).toInt(), int(PatternAction::Notify)));
+        patterns[query.value(0).toString()].append(pattern);
+    }
+
+    if (query.lastError().isValid()) {
+        qWarning() << "Failed to load patterns:" << query.lastError().text();
+    }
+    return patterns;
+}
+
+void DatabaseWorker::loadRuns(quint64 requestId, const QString& name, int limit) {
+    TRACE_SCOPE("DatabaseWorker::loadRuns");
+    // 先提交排队的写入，保证包含最近一次运行
+    flush();
+
+    QSqlQuery& query = statement("SELECT id, started_at, finished_at, duration_ms, exit_code, exit_status, "
+                                 "peak_rss_kb, output_bytes, archive FROM runs "
+                                 "WHERE command_name = ? ORDER BY started_at DESC LIMIT ?");
+    query.bindValue(0, name);
+    query.bindValue(1, limit);
+
+    QVariantList runs;
+    if (!query.exec()) {
+        qWarning() << "Failed to load runs:" << query.lastError().text();
+        emit runsLoaded(requestId, runs);
+        return;
+    }
+    while (query.next()) {
+        QVariantMap run;
+        run["id"] = query.value(0);
+        run["startedAt"] = query.value(1);
+        run["finishedAt"] = query.value(2);
+        run["durationMs"] = query.value(3);
+        run["exitCode"] = query.value(4);
+        run["exitStatus"] = query.value(5);
+        run["peakRssKb"] = query.value(6);
+        run["outputBytes"] = query.value(7);
+        run["archive"] = query.value(8);
+        runs.append(run);
+    }
+    query.finish();
+    emit runsLoaded(requestId, runs);
+}
+
+void DatabaseWorker::deleteRuns(const QString& name, const QString& archiveDir, const QString& activeArchive) {
+    TRACE_SCOPE("DatabaseWorker::deleteRuns");
+    // 先提交排队的写入，保证读到包括最近一次运行在内的全部记录
+    flush();
+
+    QSqlQuery& select = statement("SELECT archive FROM runs WHERE command_name = ?");
+    select.bindValue(0, name);
+    QStringList archives;
+    if (select.exec()) {
+        while (select.next()) {
+            archives.append(select.value(0).toString());
+        }
+    } else {
+        qWarning() << "Failed to list runs:" << select.lastError().text();
+    }
+    select.finish();
+
+    execute("DELETE FROM runs WHERE command_name = ?", { name });
+    flush();
+    for (const QString& archive : std::as_const(archives)) {
+        if (!archive.isEmpty() && archive != activeArchive) {
+            QFile::remove(archiveDir + "/" + archive);
+        }
+    }
+}
+
+void DatabaseWorker::pruneRuns(const QString& name, int keepRuns, qint64 keepBytes, const QString& archiveDir) {
+    TRACE_SCOPE("DatabaseWorker::pruneRuns");
+    // 先提交排队的写入，刚结束的运行也要计入
+    flush();
+
+    QSqlQuery& select = statement("SELECT id, archive FROM runs WHERE command_name = ? ORDER BY started_at DESC, id DESC");
+    select.bindValue(0, name);
+    QList<qint64> expired;
+    QStringList archives;
+    if (select.exec()) {
+        int kept = 0;
+        qint64 bytes = 0;
+        bool full = false;   // 从第一条超出限制的记录起，更早的全部删除
+        while (select.next()) {
+            QString archive = select.value(1).toString();
+            qint64 size = archive.isEmpty() ? 0 : QFileInfo(archiveDir + "/" + archive).size();
+            if (kept > 0 && !full) {
+                full = (keepRuns > 0 && kept >= keepRuns) || (keepBytes > 0 && bytes + size > keepBytes);
+            }
+            if (full) {
+                expired.append(select.value(0).toLongLong());
+                archives.append(archive);
+            } else {
+                ++kept;
+                bytes += size;
+            }
+        }
+    } else {
+        qWarning() << "Failed to list runs:" << select.lastError().text();
+    }
+    select.finish();
+    if (expired.isEmpty()) return;
+
+    for (qint64 id : std::as_const(expired)) {
+        execute("DELETE FROM runs WHERE id = ?", { id });
+    }
+    flush();
+    for (const QString& archive : std::as_const(archives)) {
+        if (!archive.isEmpty()) {
+            QFile::remove(archiveDir + "/" + archive);
+        }
+    }
+}
+
+void DatabaseWorker::loadCommandPage(qint64 afterId, int limit) {
+    TRACE_SCOPE("DatabaseWorker::loadCommandPage");
+    // 分页读取之前先提交排队的写入，保证读到最新数据
+    flush();
+
+    QSqlQuery& query = statement("SELECT id, name, command, launch_mode, restart_policy, tee_path, tee_rotate_bytes "
+                                 "FROM commands "
+                                 "WHERE id > ? ORDER BY id LIMIT ?");
+    query.bindValue(0, afterId);
+    query.bindValue(1, limit);
+
+    QList<StoredCommand> commands;
+    if (!query.exec()) {
+        qWarning() << "Failed to load commands:" << query.lastError().text();
+        emit commandPageLoaded(commands, true);
+        return;
+    }
+
+    while (query.next()) {
+        StoredCommand command;
+        command.id = query.value(0).toLongLong();
+        command.name = query.value(1).toString();
+        command.command = query.value(2).toString();
+        command.launchMode = query.value(3).toInt();
+        command.restartPolicy = query.value(4).toInt();
+        command.teePath = query.value(5).toString();
+        command.teeRotateBytes = query.value(6).toLongLong();
+        commands.append(command);
+    }
+    query.finish();
+    emit commandPageLoaded(commands, commands.size() < limit);
+}
+
+void DatabaseWorker::insertCommand(qint64 id, const QString& name, const QString& command) {
+    enqueue({ "INSERT INTO commands (id, name, command, created_at) VALUES (?, ?, ?, datetime('now'))",
+              { id, name, command } });
+}
+
+void DatabaseWorker::execute(const QString& sql, const QVariantList& values) {
+    enqueue({ sql, values });
+}
+
+void DatabaseWorker::flush() {
+    m_writeTimer->stop();
+    if (m_pending.isEmpty() || !m_database.isOpen()) return;
+    TRACE_SCOPE("DatabaseWorker::flush");
+    TRACE_COUNT("DatabaseWorker::writes", m_pending.size());
+
+    // 一次事务提交全部排队的写入，批量导入或编辑只需要一次 fsync
+    const QList<PendingWrite> writes = std::exchange(m_pending, {});
+    m_database.transaction();
+    for (const PendingWrite& write : writes) {
+        QSqlQuery& query = statement(write.sql);
+        // 复用的语句按位置重新绑定参数
+        for (int i = 0; i < write.values.size(); ++i) {
+            query.bindValue(i, write.values.at(i));
+        }
+        if (!query.exec()) {
+            qWarning() << "Database write failed:" << query.lastError().text() << write.sql;
+            emit writeFailed(query.lastError().text());
+            continue;
+        }
+        query.finish();
+    }
+    if (!m_database.commit()) {
+        qWarning() << "Failed to commit database writes:" << m_database.lastError().text();
+        m_database.rollback();
+        emit writeFailed(m_database.lastError().text());
+    }
+}
+
+bool DatabaseWorker::ensureColumn(const QString& table, const QString& column, const QString& definition) {
+    QSqlQuery query(m_database);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qWarning() << "Failed to read table info:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == column) return true;
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        qWarning() << "Failed to add column:" << column << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery& DatabaseWorker::statement(const QString& sql) {
+    auto it = m_statements.find(sql);
+    if (it == m_statements.end()) {
+        QSqlQuery query(m_database);
+        if (!query.prepare(sql)) {
+            qWarning() << "Failed to prepare statement:" << query.lastError().text() << sql;
+        }
+        it = m_statements.insert(sql, query);
+    }
+    return it.value();
+}
+
+void DatabaseWorker::enqueue(const PendingWrite& write) {
+    m_pending.append(write);
+    if (!m_writeTimer->isActive()) {
+        m_writeTimer->start(WriteDelay);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QVariant>
+#include "GroupLauncher.h"
+#include "OutputPatterns.h"
+
+// commands 表中的一行
+struct StoredCommand {
+    qint64 id = 0;
+    QString name;
+    QString command;
+    int launchMode = 0;
+    int restartPolicy = 0;
+    QString teePath;
+    qint64 teeRotateBytes = 0;
+};
+Q_DECLARE_METATYPE(StoredCommand)
+
+// 运行在独立线程中的 SQLite 持久化层：复用预编译语句，开启 WAL，
+// 并把短时间内的多次写入合并到同一个事务中提交
+class DatabaseWorker : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int WriteDelay = 20;   // 写入合并窗口（毫秒）
+
+    explicit DatabaseWorker(QObject* parent = nullptr);
+
+    // 以下方法都必须在数据库线程中调用
+    bool open(const QString& path);
+    void close();
+    bool commandExists(const QString& name);
+    qint64 lastCommandId();   // 已分配过的最大 id（含已删除的），新命令从其后继续编号
+    QList<CommandGroup> loadGroups();
+    QHash<QString, QList<OutputPattern>> loadPatterns();   // 命令名 -> 按位置排序的输出模式
+
+public slots:
+    void loadCommandPage(qint64 afterId, int limit);
+    void loadRuns(quint64 requestId, const QString& name, int limit);   // 最近的运行记录，新的在前
+    void insertCommand(qint64 id, const QString& name, const QString& command);
+    void execute(const QString& sql, const QVariantList& values);   // 排队写入
+    // 删除命令的全部运行记录及 archiveDir 中对应的归档文件；activeArchive 仍在写入，由进程线程负责删除
+    void deleteRuns(const QString& name, const QString& archiveDir, const QString& activeArchive);
+    // 只保留命令最近的 keepRuns 次运行，且归档文件合计不超过 keepBytes（0 表示不限制），
+    // 删除更早的记录和归档；最近一次运行总是保留
+    void pruneRuns(const QString& name, int keepRuns, qint64 keepBytes, const QString& archiveDir);
+    void flush();                                                   // 立即提交排队的写入
+
+signals:
+    void commandPageLoaded(const QList<StoredCommand>& commands, bool finished);
+    void runsLoaded(quint64 requestId, const QVariantList& runs);
+    void writeFailed(const QString& error);
+
+private:
+    struct PendingWrite {
+        QString sql;
+        QVariantList values;
+    };
+
+    QSqlQuery& statement(const QString& sql);
+    bool ensureColumn(const QString& table, const QString& column, const QString& definition);
+    void enqueue(const PendingWrite& write);
+
+    QSqlDatabase m_database;
+    QHash<QString, QSqlQuery> m_statements;   // 预编译语句缓存
+    QList<PendingWrite> m_pending;
+    QTimer* m_writeTimer;
+};
@@ -0,0 +1,267 @@
+#include "GroupLauncher.h"
+#include "CommandManager.h"
+#include <QDebug>
+#include <QHash>
+#include <QSet>
+#include <functional>
+
+GroupLauncher::GroupLauncher(CommandManager* manager, const CommandGroup& group, QObject* parent)
+    : QObject(parent), m_manager(manager), m_group(group) {
+    for (const GroupMember& member : group.members) {
+        MemberRun run;
+        run.member = member;
+        if (!member.readyPattern.isEmpty()) {
+            run.pattern.setPattern(member.readyPattern);
+            if (!run.pattern.isValid()) {
+                qWarning() << "Invalid ready pattern for" << member.command << ":" << run.pattern.errorString();
+            }
+        }
+        m_runs.append(run);
+    }
+}
+
+void GroupLauncher::start() {
+    connect(m_manager, &CommandManager::commandStatusChanged, this, &GroupLauncher::onStatusChanged);
+    connect(m_manager, &CommandManager::outputUpdated, this, &GroupLauncher::onOutputUpdated);
+    connect(m_manager, &CommandManager::commandFinished, this, &GroupLauncher::onCommandFinished);
+    connect(m_manager, &CommandManager::commandReady, this, &GroupLauncher::onCommandReady);
+
+    qDebug() << "Starting group:" << m_group.name << "members:" << m_runs.size()
+             << "max concurrency:" << m_group.maxConcurrency;
+    m_clock.start();
+    schedule();
+}
+
+void GroupLauncher::schedule() {
+    if (m_finished) return;
+
+    int launching = 0;
+    for (const MemberRun& run : std::as_const(m_runs)) {
+        if (run.state == State::Launching) ++launching;
+    }
+
+    bool progressPossible = launching > 0;
+    for (MemberRun& run : m_runs) {
+        if (run.state != State::Pending) continue;
+
+        bool depsReady = true;
+        QString failedDep;
+        for (const QString& dep : std::as_const(run.member.dependsOn)) {
+            const MemberRun* depRun = findRun(dep);
+            if (!depRun) continue;  // 不在组内的依赖视为已满足
+            if (depRun->state == State::Failed) {
+                failedDep = dep;
+                break;
+            }
+            if (depRun->state != State::Ready) {
+                depsReady = false;
+            }
+        }
+
+        if (!failedDep.isEmpty()) {
+            markFailed(run, "dependency failed: " + failedDep);
+            progressPossible = true;
+            continue;
+        }
+        if (!depsReady) continue;
+
+        progressPossible = true;
+        if (launching >= qMax(1, m_group.maxConcurrency)) continue;
+
+        launch(run);
+        if (run.state == State::Launching) ++launching;
+    }
+
+    // 没有正在启动的成员，剩余成员又都无法启动，说明依赖存在环
+    if (!progressPossible) {
+        for (MemberRun& run : m_runs) {
+            if (run.state == State::Pending) {
+                markFailed(run, "dependency cycle");
+            }
+        }
+    }
+
+    checkFinished();
+}
+
+void GroupLauncher::launch(MemberRun& run) {
+    const QString& name = run.member.command;
+    run.launchedAt = m_clock.elapsed();
+
+    if (m_manager->getCommandContent(name).isEmpty()) {
+        markFailed(run, "command not found");
+        return;
+    }
+    if (!run.member.readyPattern.isEmpty() && !run.pattern.isValid()) {
+        markFailed(run, "invalid ready pattern");
+        return;
+    }
+
+    run.state = State::Launching;
+    if (m_manager->isRunning(name)) {
+        // 已经在运行的命令：没有就绪条件时直接视为就绪，否则从已保留的输出开始匹配
+        if (run.member.readyPattern.isEmpty() && !run.member.waitForExit) {
+            markReady(run);
+            return;
+        }
+        run.outputOffset = -1;
+        onOutputUpdated(name);
+        return;
+    }
+
+    run.outputOffset = m_manager->readOutput(name, -1).value("end").toLongLong();
+    m_manager->startCommand(name);
+}
+
+void GroupLauncher::markReady(MemberRun& run) {
+    if (run.state == State::Ready || run.state == State::Failed) return;
+    run.state = State::Ready;
+    run.readyAt = m_clock.elapsed();
+    run.carry.clear();
+
+    int ready = 0;
+    for (const MemberRun& r : std::as_const(m_runs)) {
+        if (r.state == State::Ready) ++ready;
+    }
+    qDebug() << "Group" << m_group.name << "member ready:" << run.member.command
+             << "after" << (run.readyAt - run.launchedAt) << "ms";
+    emit progress(m_group.name, ready, m_runs.size());
+
+    // 延迟调度，避免在信号处理过程中重入
+    QMetaObject::invokeMethod(this, &GroupLauncher::schedule, Qt::QueuedConnection);
+}
+
+void GroupLauncher::markFailed(MemberRun& run, const QString& reason) {
+    if (run.state == State::Ready || run.state == State::Failed) return;
+    run.state = State::Failed;
+    run.carry.clear();
+    qWarning() << "Group" << m_group.name << "member failed:" << run.member.command << reason;
+    QMetaObject::invokeMethod(this, &GroupLauncher::schedule, Qt::QueuedConnection);
+}
+
+void GroupLauncher::checkFinished() {
+    if (m_finished) return;
+
+    bool success = true;
+    for (const MemberRun& run : std::as_const(m_runs)) {
+        if (run.state == State::Pending || run.state == State::Launching) return;
+        if (run.state == State::Failed) success = false;
+    }
+
+    // 关键路径：沿依赖链累加各成员从启动到就绪的耗时，取最长的一条
+    QHash<QString, qint64> pathTime;
+    QHash<QString, QString> pathPrev;
+    QSet<QString> visiting;
+    std::function<qint64(const MemberRun&)> longest = [&](const MemberRun& run) -> qint64 {
+        const QString& name = run.member.command;
+        if (pathTime.contains(name)) return pathTime.value(name);
+        if (visiting.contains(name)) return 0;
+        visiting.insert(name);
+
+        qint64 best = 0;
+        QString bestPrev;
+        for (const QString& dep : run.member.dependsOn) {
+            const MemberRun* depRun = findRun(dep);
+            if (!depRun) continue;
+            qint64 t = longest(*depRun);
+            if (t > best) {
+                best = t;
+                bestPrev = dep;
+            }
+        }
+        qint64 own = run.state == State::Ready ? run.readyAt - run.launchedAt : 0;
+        pathTime.insert(name, best + own);
+        pathPrev.insert(name, bestPrev);
+        visiting.remove(name);
+        return best + own;
+    };
+
+    qint64 criticalMs = 0;
+    QString tail;
+    for (const MemberRun& run : std::as_const(m_runs)) {
+        qint64 t = longest(run);
+        if (tail.isEmpty() || t > criticalMs) {
+            criticalMs = t;
+            tail = run.member.command;
+        }
+    }
+
+    QStringList path;
+    for (QString name = tail; !name.isEmpty(); name = pathPrev.value(name)) {
+        path.prepend(name);
+    }
+
+    m_finished = true;
+    disconnect(m_manager, nullptr, this, nullptr);
+
+    qint64 wallMs = m_clock.elapsed();
+    qDebug() << "Group finished:" << m_group.name << "success:" << success << "wall time:" << wallMs
+             << "ms critical path:" << criticalMs << "ms" << path;
+    emit finished(m_group.name, success, wallMs, criticalMs, path);
+}
+
+GroupLauncher::MemberRun* GroupLauncher::findRun(const QString& command) {
+    for (MemberRun& run : m_runs) {
+        if (run.member.command == command) return &run;
+    }
+    return nullptr;
+}
+
+void GroupLauncher::onStatusChanged(const QString& name, bool running) {
+    MemberRun* run = findRun(name);
+    if (!run || run->state != State::Launching) return;
+
+    if (running) {
+        // 命令自身配置了就绪模式时，等待 commandReady
+        if (run->member.readyPattern.isEmpty() && !run->member.waitForExit &&
+            !m_manager->hasReadyPattern(name)) {
+            markReady(*run);
+        }
+    } else if (!m_manager->isRunning(name)) {
+        // 启动失败或在满足就绪条件之前就已退出
+        markFailed(*run, "exited before ready");
+    }
+}
+
+void GroupLauncher::onOutputUpdated(const QString& name) {
+    MemberRun* run = findRun(name);
+    if (!run || run->state != State::Launching || run->member.readyPattern.isEmpty()) return;
+
+    QVariantMap delta = m_manager->readOutput(name, run->outputOffset);
+    if (delta.isEmpty()) return;
+    if (delta.value("reset").toBool()) {
+        run->carry.clear();
+    }
+    run->outputOffset = delta.value("end").toLongLong();
+
+    // 只扫描新增内容，加上上一块残留的不完整行以处理跨块匹配
+    QString text = run->carry + delta.value("text").toString();
+    if (run->pattern.match(text).hasMatch()) {
+        markReady(*run);
+        return;
+    }
+
+    qsizetype lastNewline = text.lastIndexOf(QLatin1Char('\n'));
+    run->carry = text.mid(lastNewline + 1).right(4096);
+}
+
+void GroupLauncher::onCommandReady(const QString& name) {
+    MemberRun* run = findRun(name);
+    if (!run || run->state != State::Launching) return;
+
+    // 组成员自己的就绪条件优先
+    if (run->member.readyPattern.isEmpty() && !run->member.waitForExit) {
+        markReady(*run);
+    }
+}
+
+void GroupLauncher::onCommandFinished(const QString& name, int exitCode, int exitStatus) {
+    MemberRun* run = findRun(name);
+    if (!run || run->state != State::Launching) return;
+
+    if (run->member.waitForExit && exitStatus == QProcess::NormalExit && exitCode == 0) {
+        markReady(*run);
+    } else {
+        markFailed(*run, QString("exited with code %1").arg(exitCode));
+    }
+}
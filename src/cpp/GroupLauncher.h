@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+
+class CommandManager;
+
+// 命令组中的一个成员及其就绪条件
+struct GroupMember {
+    QString command;
+    QStringList dependsOn;     // 这些成员就绪后才启动本成员
+    QString readyPattern;      // 输出匹配该正则后视为就绪
+    bool waitForExit = false;  // 为 true 时等到以退出码 0 结束才视为就绪
+};
+
+struct CommandGroup {
+    QString name;
+    int maxConcurrency = 4;    // 同时处于“已启动但未就绪”状态的成员上限
+    QList<GroupMember> members;
+};
+
+// 按依赖顺序和并发上限启动一个命令组，结束时报告总耗时和关键路径
+class GroupLauncher : public QObject {
+    Q_OBJECT
+
+public:
+    GroupLauncher(CommandManager* manager, const CommandGroup& group, QObject* parent = nullptr);
+
+    void start();
+    QString groupName() const { return m_group.name; }
+    bool isFinished() const { return m_finished; }
+
+signals:
+    void progress(const QString& group, int ready, int total);
+    void finished(const QString& group, bool success, qint64 wallTimeMs,
+                  qint64 criticalPathMs, const QStringList& criticalPath);
+
+private:
+    enum class State { Pending, Launching, Ready, Failed };
+
+    struct MemberRun {
+        GroupMember member;
+        QRegularExpression pattern;
+        State state = State::Pending;
+        qint64 outputOffset = 0;   // 已扫描到的输出位置
+        QString carry;             // 尚未遇到换行的残留行，用于跨块匹配
+        qint64 launchedAt = -1;
+        qint64 readyAt = -1;
+    };
+
+    void schedule();
+    void launch(MemberRun& run);
+    void markReady(MemberRun& run);
+    void markFailed(MemberRun& run, const QString& reason);
+    void checkFinished();
+    MemberRun* findRun(const QString& command);
+
+    void onStatusChanged(const QString& name, bool running);
+    void onOutputUpdated(const QString& name);
+    void onCommandReady(const QString& name);
+    void onCommandFinished(const QString& name, int exitCode, int exitStatus);
+
+    CommandManager* m_manager;
+    CommandGroup m_group;
+    QList<MemberRun> m_runs;
+    QElapsedTimer m_clock;
+    bool m_finished = false;
+};
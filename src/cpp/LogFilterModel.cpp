@@ -0,0 +1,39 @@
+#include "LogFilterModel.h"
+#include "LogModel.h"
+
+LogFilterModel::LogFilterModel(LogModel* source, int stream, QObject* parent)
+    : QSortFilterProxyModel(parent), m_source(source), m_stream(stream) {
+    setSourceModel(source);
+    setDynamicSortFilter(true);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &LogFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &LogFilterModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &LogFilterModel::countChanged);
+}
+
+bool LogFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    // 只读取行元数据，不解码内容
+    return m_source->index(sourceRow, 0, sourceParent).data(LogModel::StreamRole).toInt() == m_stream;
+}
+
+int LogFilterModel::rowForSource(int sourceRow) const {
+    int rows = rowCount();
+    if (rows == 0 || sourceRow < 0) return rows > 0 ? 0 : -1;
+
+    int low = 0;
+    int high = rows;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (mapToSource(index(mid, 0)).row() < sourceRow) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return qMin(low, rows - 1);
+}
+
+int LogFilterModel::rowAtTime(const QString& time) const {
+    int sourceRow = m_source->rowAtTime(time);
+    return sourceRow < 0 ? -1 : rowForSource(sourceRow);
+}
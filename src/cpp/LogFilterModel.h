@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+
+class LogModel;
+
+// 按来源管道过滤输出行，只在输出窗口打开过滤时创建。
+// 不排序，代理行与源行保持相同顺序，因此可以二分查找对应位置
+class LogFilterModel : public QSortFilterProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit LogFilterModel(LogModel* source, int stream, QObject* parent = nullptr);
+
+    int count() const { return rowCount(); }
+
+    // 源行 sourceRow 被过滤掉时返回其后第一条保留的行，没有时返回最后一行
+    Q_INVOKABLE int rowForSource(int sourceRow) const;
+    // 与 LogModel::rowAtTime 相同，返回代理中的行号
+    Q_INVOKABLE int rowAtTime(const QString& time) const;
+
+signals:
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    LogModel* m_source;
+    int m_stream;
+};
@@ -0,0 +1,133 @@
+#include "LogModel.h"
+#include "CommandManager.h"
+#include "Tracing.h"
+#include <QDateTime>
+
+LogModel::LogModel(CommandEntry* entry, QObject* parent)
+    : QAbstractListModel(parent), m_entry(entry) {
+    const OutputBuffer& buffer = entry->outputBuffer();
+    m_firstRow = buffer.firstRowNumber();
+    m_rows = int(buffer.rowCount());
+    connect(entry, &CommandEntry::outputChanged, this, &LogModel::sync);
+    connect(entry, &CommandEntry::highlightPatternsChanged, this, &LogModel::refreshHighlights);
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+    if (!m_entry || !index.isValid() || index.row() >= m_rows) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case TextRole:
+        return Ansi::plainText(m_entry->outputBuffer().row(index.row()));
+    case LineNumberRole:
+        return m_firstRow + index.row() + 1;
+    case HighlightRole:
+        return m_entry->isHighlighted(Ansi::plainText(m_entry->outputBuffer().row(index.row())));
+    case StyledTextRole: {
+        const OutputBuffer& buffer = m_entry->outputBuffer();
+        return Ansi::styledText(buffer.row(index.row()), buffer.rowStyle(index.row()));
+    }
+    case TimeRole: {
+        // 单调时钟换算为墙上时间，不受系统时间调整影响
+        qint64 age = OutputBuffer::monotonicMs() - m_entry->outputBuffer().rowTime(index.row());
+        return QDateTime::fromMSecsSinceEpoch(QDateTime::currentMSecsSinceEpoch() - age).toString("hh:mm:ss.zzz");
+    }
+    case StreamRole:
+        return int(m_entry->outputBuffer().rowStream(index.row()));
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> LogModel::roleNames() const {
+    return {
+        { TextRole, "text" },
+        { LineNumberRole, "lineNumber" },
+        { HighlightRole, "highlighted" },
+        { StyledTextRole, "styledText" },
+        { TimeRole, "time" },
+        { StreamRole, "stream" }
+    };
+}
+
+int LogModel::rowAtTime(const QString& time) const {
+    if (!m_entry || m_rows == 0) return -1;
+
+    QTime target;
+    for (const char* format : { "hh:mm:ss.zzz", "hh:mm:ss", "hh:mm", "h:mm:ss", "h:mm" }) {
+        target = QTime::fromString(time.trimmed(), QLatin1String(format));
+        if (target.isValid()) break;
+    }
+    if (!target.isValid()) return -1;
+
+    // 取不晚于现在的最近一次该时刻，再换算到单调时钟
+    QDateTime now = QDateTime::currentDateTime();
+    QDateTime wall(now.date(), target);
+    if (wall > now) wall = wall.addDays(-1);
+    qint64 timestamp = OutputBuffer::monotonicMs() - wall.msecsTo(now);
+
+    qint64 row = m_entry->outputBuffer().rowAtTime(timestamp);
+    return row < m_rows ? int(row) : m_rows - 1;
+}
+
+void LogModel::refreshHighlights() {
+    if (m_rows > 0) {
+        emit dataChanged(index(0), index(m_rows - 1), { HighlightRole });
+    }
+}
+
+void LogModel::sync() {
+    if (!m_entry) return;
+    TRACE_SCOPE("LogModel::sync");
+
+    const OutputBuffer& buffer = m_entry->outputBuffer();
+    qint64 first = buffer.firstRowNumber();
+    int rows = int(buffer.rowCount());
+    int oldRows = m_rows;
+
+    // 新旧行号区间不重叠（例如清空后）时直接重置
+    if (first < m_firstRow || first >= m_firstRow + m_rows || rows == 0) {
+        if (oldRows == 0 && rows == 0) {
+            m_firstRow = first;
+            return;
+        }
+        beginResetModel();
+        m_firstRow = first;
+        m_rows = rows;
+        endResetModel();
+        emit countChanged();
+        return;
+    }
+
+    // 头部被淘汰的行
+    int removed = int(first - m_firstRow);
+    if (removed > 0) {
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        m_firstRow = first;
+        m_rows -= removed;
+        endRemoveRows();
+        // 被截断的首行内容也变了
+        emit dataChanged(index(0), index(0), { TextRole, HighlightRole, StyledTextRole, TimeRole, StreamRole });
+    }
+
+    // 原来的最后一行可能继续追加了内容
+    if (m_rows > 0) {
+        emit dataChanged(index(m_rows - 1), index(m_rows - 1), { TextRole, HighlightRole, StyledTextRole, TimeRole, StreamRole });
+    }
+
+    if (rows > m_rows) {
+        beginInsertRows(QModelIndex(), m_rows, rows - 1);
+        m_rows = rows;
+        endInsertRows();
+    }
+
+    if (m_rows != oldRows) {
+        emit countChanged();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+
+class CommandEntry;
+
+// 基于输出缓冲行索引的只读日志模型，ListView 只为可见行创建委托，
+// 原始字节也只在可见行被读取时才解码和解析颜色
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TextRole = Qt::UserRole + 1,
+        LineNumberRole,
+        HighlightRole,    // 该行是否命中命令的高亮模式，只为可见行计算
+        StyledTextRole,   // 带 ANSI 颜色的行转换成的 StyledText，无颜色的行为空字符串
+        TimeRole,         // 行首到达的本地时间 hh:mm:ss.zzz
+        StreamRole        // 0 为 stdout，1 为 stderr
+    };
+
+    explicit LogModel(CommandEntry* entry, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // 第一行不早于 time（hh:mm[:ss[.zzz]]，指最近 24 小时内的该时刻）的行号，无效或没有时返回 -1
+    Q_INVOKABLE int rowAtTime(const QString& time) const;
+
+signals:
+    void countChanged();
+
+private:
+    void sync();
+    void refreshHighlights();
+
+    QPointer<CommandEntry> m_entry;
+    qint64 m_firstRow = 0;   // 模型第 0 行对应的绝对行号
+    int m_rows = 0;
+};
@@ -0,0 +1,237 @@
+#include "OutputBuffer.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <chrono>
+
+OutputBuffer::OutputBuffer(qsizetype chunkSize)
+    : m_chunkSize(qMax<qsizetype>(chunkSize, 1024)), m_timeBase(monotonicMs()) {}
+
+qint64 OutputBuffer::monotonicMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+quint32 OutputBuffer::packMeta(OutputStream stream, qint64 timestamp) {
+    // 两个管道分别读取，时间可能略有交错；保持单调以便按时间二分查找
+    quint32 time = quint32(qBound<qint64>(0, timestamp - m_timeBase, TimeMask));
+    m_lastTime = qMax(m_lastTime, time);
+    return m_lastTime | (stream == OutputStream::Stderr ? StderrFlag : 0u);
+}
+
+void OutputBuffer::append(QByteArrayView data, OutputStream stream, qint64 timestamp) {
+    if (data.isEmpty()) return;
+
+    quint32 meta = packMeta(stream, timestamp < 0 ? monotonicMs() : timestamp);
+    if (m_rowStarts.empty()) {
+        m_rowStarts.push_back(endOffset());
+        m_rowStyles.push_back(m_parser.style());
+        m_rowMeta.push_back(meta);
+    } else if (m_rowStarts.back() == endOffset()) {
+        // 上一次以换行结束，新行的第一个字节现在才到达
+        m_rowMeta.back() = meta;
+    }
+    // 逐行推进 SGR 解析，记下每一行开始时的样式；行的时间和来源取其第一个字节所在的片段
+    qint64 base = endOffset();
+    qsizetype from = 0;
+    for (qsizetype i = data.indexOf('\n'); i >= 0; i = data.indexOf('\n', i + 1)) {
+        m_parser.feed(data.sliced(from, i + 1 - from));
+        from = i + 1;
+        m_rowStarts.push_back(base + i + 1);
+        m_rowStyles.push_back(m_parser.style());
+        m_rowMeta.push_back(meta);
+    }
+    m_parser.feed(data.sliced(from));
+
+    qsizetype pos = 0;
+    while (pos < data.size()) {
+        if (m_chunks.empty() || m_chunks.back().data.size() >= m_chunkSize) {
+            m_chunks.emplace_back();
+            m_chunks.back().data.reserve(m_chunkSize);
+        }
+
+        Chunk& chunk = m_chunks.back();
+        qsizetype count = qMin(m_chunkSize - chunk.data.size(), data.size() - pos);
+        QByteArrayView piece = data.sliced(pos, count);
+        qint64 lines = piece.count('\n');
+
+        chunk.data.append(piece);
+        chunk.lines += lines;
+        m_size += count;
+        m_lines += lines;
+        pos += count;
+    }
+
+    enforceLimits();
+}
+
+void OutputBuffer::clear() {
+    m_chunks.clear();
+    m_firstRow += qint64(m_rowStarts.size());
+    m_rowStarts.clear();
+    m_rowStyles.clear();
+    m_rowMeta.clear();
+    m_startOffset += m_size;
+    m_size = 0;
+    m_lines = 0;
+}
+
+QByteArray OutputBuffer::data() const {
+    return mid(m_startOffset, m_size);
+}
+
+QByteArray OutputBuffer::mid(qint64 offset, qint64 length) const {
+    qint64 begin = qMax(offset, m_startOffset);
+    qint64 end = endOffset();
+    if (length >= 0) {
+        end = qMin(end, offset + length);
+    }
+    if (begin >= end) {
+        return QByteArray();
+    }
+
+    QByteArray result;
+    result.reserve(end - begin);
+
+    qint64 relative = begin - m_startOffset;
+    size_t index = size_t(relative / m_chunkSize);
+    qsizetype inChunk = qsizetype(relative % m_chunkSize);
+    qint64 remaining = end - begin;
+
+    while (remaining > 0 && index < m_chunks.size()) {
+        const QByteArray& data = m_chunks[index].data;
+        qsizetype count = qsizetype(qMin<qint64>(data.size() - inChunk, remaining));
+        result.append(QByteArrayView(data).sliced(inChunk, count));
+        remaining -= count;
+        inChunk = 0;
+        ++index;
+    }
+    return result;
+}
+
+OutputSnapshot OutputBuffer::snapshot(qint64 from) const {
+    OutputSnapshot snapshot;
+    snapshot.begin = qBound(m_startOffset, from, endOffset());
+    snapshot.end = endOffset();
+    snapshot.chunkSize = m_chunkSize;
+
+    size_t index = size_t((snapshot.begin - m_startOffset) / m_chunkSize);
+    snapshot.chunkStart = m_startOffset + qint64(index) * m_chunkSize;
+    for (; index < m_chunks.size(); ++index) {
+        snapshot.chunks.append(m_chunks[index].data);
+    }
+    return snapshot;
+}
+
+QByteArray OutputSnapshot::mid(qint64 offset, qint64 length) const {
+    qint64 from = qMax(offset, begin);
+    qint64 to = qMin(end, offset + length);
+    if (from >= to || chunkSize <= 0) {
+        return QByteArray();
+    }
+
+    QByteArray result;
+    result.reserve(to - from);
+    qsizetype index = qsizetype((from - chunkStart) / chunkSize);
+    qsizetype inChunk = qsizetype((from - chunkStart) % chunkSize);
+    qint64 remaining = to - from;
+    while (remaining > 0 && index < chunks.size()) {
+        const QByteArray& data = chunks.at(index);
+        qsizetype count = qsizetype(qMin<qint64>(data.size() - inChunk, remaining));
+        result.append(QByteArrayView(data).sliced(inChunk, count));
+        remaining -= count;
+        inChunk = 0;
+        ++index;
+    }
+    return result;
+}
+
+qint64 OutputBuffer::completeEndOffset() const {
+    // 未结束的序列不会超过 Ansi 向前查找的范围，只需检查末尾一小段
+    constexpr qint64 TailWindow = 256;
+    qint64 end = endOffset();
+    QByteArray tail = mid(end - TailWindow, TailWindow);
+    return end - Ansi::incompleteTail(tail);
+}
+
+qint64 OutputBuffer::rowCount() const {
+    qint64 rows = qint64(m_rowStarts.size());
+    // 末尾换行之后还没有内容时，不算作新的一行
+    if (rows > 0 && m_rowStarts.back() == endOffset()) {
+        --rows;
+    }
+    return rows;
+}
+
+qint64 OutputBuffer::rowAtTime(qint64 timestamp) const {
+    qint64 rows = rowCount();
+    if (timestamp <= m_timeBase) return 0;
+    quint32 time = quint32(qMin<qint64>(timestamp - m_timeBase, TimeMask));
+    auto end = m_rowMeta.begin() + rows;
+    auto it = std::lower_bound(m_rowMeta.begin(), end, time, [](quint32 meta, quint32 value) {
+        return (meta & TimeMask) < value;
+    });
+    return qint64(it - m_rowMeta.begin());
+}
+
+qint64 OutputBuffer::rowAtOffset(qint64 offset) const {
+    if (offset < m_startOffset || offset >= endOffset() || m_rowStarts.empty()) return -1;
+    auto it = std::upper_bound(m_rowStarts.begin(), m_rowStarts.end(), offset);
+    return qint64(it - m_rowStarts.begin()) - 1;
+}
+
+QByteArray OutputBuffer::row(qint64 row) const {
+    if (row < 0 || row >= rowCount()) {
+        return QByteArray();
+    }
+    qint64 begin = m_rowStarts[size_t(row)];
+    qint64 end = size_t(row + 1) < m_rowStarts.size() ? m_rowStarts[size_t(row + 1)] : endOffset();
+    QByteArray line = mid(begin, end - begin);
+    if (line.endsWith('\n')) line.chop(1);
+    if (line.endsWith('\r')) line.chop(1);
+    return line;
+}
+
+void OutputBuffer::setMaxBytes(qint64 bytes) {
+    m_maxBytes = bytes;
+    enforceLimits();
+}
+
+void OutputBuffer::setMaxLines(qint64 lines) {
+    m_maxLines = lines;
+    enforceLimits();
+}
+
+void OutputBuffer::enforceLimits() {
+    // 只淘汰完整的旧块，正在写入的最后一块始终保留
+    while (m_chunks.size() > 1) {
+        bool overBytes = m_maxBytes > 0 && byteSize() > m_maxBytes;
+        bool overLines = m_maxLines > 0 && m_lines > m_maxLines;
+        if (!overBytes && !overLines) {
+            break;
+        }
+
+        const Chunk& oldest = m_chunks.front();
+        m_startOffset += oldest.data.size();
+        m_size -= oldest.data.size();
+        m_lines -= oldest.lines;
+        m_chunks.pop_front();
+
+        // 丢弃已淘汰的行；被截断的行从新的起点继续作为第 0 行，沿用原来的起始样式
+        quint32 truncatedStyle = m_rowStyles.empty() ? Ansi::SgrState().pack() : m_rowStyles.front();
+        quint32 truncatedMeta = m_rowMeta.empty() ? 0 : m_rowMeta.front();
+        while (!m_rowStarts.empty() && m_rowStarts.front() < m_startOffset) {
+            truncatedStyle = m_rowStyles.front();
+            truncatedMeta = m_rowMeta.front();
+            m_rowStarts.pop_front();
+            m_rowStyles.pop_front();
+            m_rowMeta.pop_front();
+            ++m_firstRow;
+        }
+        if (m_size > 0 && (m_rowStarts.empty() || m_rowStarts.front() > m_startOffset)) {
+            m_rowStarts.push_front(m_startOffset);
+            m_rowStyles.push_front(truncatedStyle);
+            m_rowMeta.push_front(truncatedMeta);
+            --m_firstRow;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "AnsiText.h"
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QMetaType>
+#include <deque>
+
+enum class OutputStream : quint8 {
+    Stdout = 0,
+    Stderr = 1
+};
+
+// 工作线程一次刷新中连续的一段输出：来自同一管道、在同一毫秒读取
+struct OutputSegment {
+    qint64 length = 0;
+    qint64 timestamp = 0;   // OutputBuffer::monotonicMs() 时钟
+    OutputStream stream = OutputStream::Stdout;
+};
+Q_DECLARE_METATYPE(OutputSegment)
+
+// 某一时刻保留内容的只读快照。块是隐式共享的，复制只增加引用计数，可以交给其他线程读取；
+// 缓冲之后继续写入最后一块时才会复制这一块
+struct OutputSnapshot {
+    qint64 begin = 0;        // 快照内容的起始绝对偏移
+    qint64 end = 0;
+    qint64 chunkStart = 0;   // chunks.first() 的起始绝对偏移
+    qsizetype chunkSize = 0;
+    QList<QByteArray> chunks;
+
+    QByteArray mid(qint64 offset, qint64 length) const;
+};
+
+// 命令输出存储：按固定大小分块保存进程写出的原始字节，超过字节/行数上限时淘汰最旧的块，
+// 使长时间运行的命令占用的内存保持平稳。解码和转义序列处理推迟到读取时，只处理被查看的范围
+class OutputBuffer {
+public:
+    static constexpr qsizetype DefaultChunkSize = 64 * 1024;       // 每块字节数
+    static constexpr qint64 DefaultMaxBytes = 16 * 1024 * 1024;    // 默认最多保留 16MB
+    static constexpr qint64 DefaultMaxLines = 200000;              // 默认最多保留 20 万行
+
+    explicit OutputBuffer(qsizetype chunkSize = DefaultChunkSize);
+
+    // 单调时钟（毫秒），工作线程读取管道时和界面线程使用同一时钟
+    static qint64 monotonicMs();
+
+    // timestamp < 0 时使用当前时间
+    void append(QByteArrayView data, OutputStream stream = OutputStream::Stdout, qint64 timestamp = -1);
+    void clear();
+
+    QByteArray data() const;                                  // 当前保留的全部原始字节
+    QByteArray mid(qint64 offset, qint64 length = -1) const;  // 按绝对偏移读取
+    OutputSnapshot snapshot(qint64 from) const;               // [from, end) 的快照
+
+    // 偏移量是自第一次写入以来累计的字节位置，淘汰旧内容后不会回退
+    qint64 startOffset() const { return m_startOffset; }
+    qint64 endOffset() const { return m_startOffset + m_size; }
+    // 去掉末尾未结束的转义序列或多字节字符后的结束位置，增量读取只读到这里
+    qint64 completeEndOffset() const;
+    qint64 size() const { return m_size; }
+    qint64 byteSize() const { return m_size; }
+    qint64 lineCount() const { return m_lines; }   // 保留内容中的换行符数量
+    bool isEmpty() const { return m_size == 0; }
+
+    // 行索引：记录每一行起始的绝对偏移、该处的 SGR 样式，以及行首字节到达的时间和来源管道，
+    // 供按行随机访问、着色和按时间定位而不复制全部内容
+    qint64 rowCount() const;
+    qint64 firstRowNumber() const { return m_firstRow; }  // 第 0 行自开始以来的行号
+    qint64 rowStart(qint64 row) const { return m_rowStarts[size_t(row)]; }
+    quint32 rowStyle(qint64 row) const { return m_rowStyles[size_t(row)]; }
+    qint64 rowTime(qint64 row) const { return m_timeBase + (m_rowMeta[size_t(row)] & TimeMask); }
+    OutputStream rowStream(qint64 row) const {
+        return (m_rowMeta[size_t(row)] & StderrFlag) ? OutputStream::Stderr : OutputStream::Stdout;
+    }
+    qint64 rowAtTime(qint64 timestamp) const;             // 第一个不早于 timestamp 的行，没有时返回 rowCount()
+    qint64 rowAtOffset(qint64 offset) const;              // 包含该偏移的行，已淘汰时返回 -1
+    QByteArray row(qint64 row) const;                     // 原始字节，不含行尾换行符
+
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 maxLines() const { return m_maxLines; }
+    void setMaxBytes(qint64 bytes);   // <= 0 表示不限制
+    void setMaxLines(qint64 lines);   // <= 0 表示不限制
+
+private:
+    // 行元数据打包为 4 字节：最高位标记 stderr，低 31 位为相对 m_timeBase 的毫秒数（约 24 天）
+    static constexpr quint32 StderrFlag = 0x80000000u;
+    static constexpr quint32 TimeMask = 0x7FFFFFFFu;
+
+    struct Chunk {
+        QByteArray data;
+        qint64 lines = 0;
+    };
+
+    void enforceLimits();
+    quint32 packMeta(OutputStream stream, qint64 timestamp);
+
+    // 除最后一块外每块都恰好写满 m_chunkSize 个字节，因此可按偏移直接定位
+    std::deque<Chunk> m_chunks;
+    qsizetype m_chunkSize;
+    qint64 m_startOffset = 0;
+    qint64 m_size = 0;
+    qint64 m_lines = 0;
+    qint64 m_maxBytes = DefaultMaxBytes;
+    qint64 m_maxLines = DefaultMaxLines;
+    std::deque<qint64> m_rowStarts;
+    std::deque<quint32> m_rowStyles;   // 与 m_rowStarts 一一对应
+    std::deque<quint32> m_rowMeta;     // 与 m_rowStarts 一一对应，时间单调不减
+    qint64 m_timeBase;
+    quint32 m_lastTime = 0;
+    qint64 m_firstRow = 0;
+    Ansi::SgrParser m_parser;          // 随写入增量推进，清空输出后样式仍然延续
+};
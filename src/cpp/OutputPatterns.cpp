@@ -0,0 +1,93 @@
+#include "OutputPatterns.h"
+#include "AnsiText.h"
+#include <QDebug>
+
+PatternMatcher::PatternMatcher(const QList<OutputPattern>& patterns) {
+    for (Stream& stream : m_streams) {
+#ifdef Q_OS_WIN
+        stream.decoder = QStringDecoder(QStringConverter::System);
+#else
+        stream.decoder = QStringDecoder(QStringConverter::Utf8);
+#endif
+    }
+    for (int i = 0; i < patterns.size(); ++i) {
+        QRegularExpression regex(patterns.at(i).pattern);
+        if (!regex.isValid()) {
+            qWarning() << "Invalid output pattern:" << patterns.at(i).pattern << regex.errorString();
+            regex = QRegularExpression(QStringLiteral("(?!)"));   // 永不匹配，保持序号对应
+        }
+        regex.optimize();
+        m_patterns.append({ regex, patterns.at(i).action });
+    }
+}
+
+QList<PatternHit> PatternMatcher::feed(int stream, QByteArrayView data, int& highlights) {
+    QList<PatternHit> hits;
+    if (m_patterns.isEmpty() || stream < 0 || stream >= StreamCount) return hits;
+
+    Stream& state = m_streams[stream];
+    const QString decoded = state.decoder.decode(data);
+    QStringView text(decoded);
+    qsizetype start = 0;
+    for (qsizetype end = text.indexOf(u'\n'); end >= 0; end = text.indexOf(u'\n', start)) {
+        QStringView piece = text.mid(start, end - start);
+        if (state.carry.isEmpty()) {
+            matchLine(piece, hits, highlights, false);
+        } else {
+            state.carry.append(piece.left(MaxLineLength - state.carry.size()));
+            matchLine(state.carry, hits, highlights, false);
+            state.carry.clear();
+        }
+        start = end + 1;
+    }
+
+    // 剩余的不完整行留到下一次；超长行只保留前 MaxLineLength 个字符
+    QStringView rest = text.mid(start);
+    if (!rest.isEmpty() && state.carry.size() < MaxLineLength) {
+        state.carry.append(rest.left(MaxLineLength - state.carry.size()));
+    }
+    // 提示符等不换行的输出也可以触发就绪
+    if (!m_ready && !state.carry.isEmpty()) {
+        matchLine(state.carry, hits, highlights, true);
+    }
+    return hits;
+}
+
+QList<PatternHit> PatternMatcher::finish(int& highlights) {
+    QList<PatternHit> hits;
+    for (Stream& state : m_streams) {
+        if (!state.carry.isEmpty()) {
+            matchLine(state.carry, hits, highlights, false);
+            state.carry.clear();
+        }
+    }
+    return hits;
+}
+
+void PatternMatcher::matchLine(QStringView line, QList<PatternHit>& hits, int& highlights, bool partial) {
+    if (line.endsWith(u'\r')) line.chop(1);
+    line = line.left(MaxLineLength);
+    QString plain;
+    if (line.contains(u'\x1b')) {
+        plain = Ansi::stripped(line);
+        line = plain;
+    }
+
+    for (int i = 0; i < m_patterns.size(); ++i) {
+        const Compiled& p = m_patterns.at(i);
+        // 不完整的行只用于检测就绪，其余动作等整行到齐再判断，避免重复报告
+        if (partial && p.action != PatternAction::Ready) continue;
+        if (p.action == PatternAction::Ready && m_ready) continue;
+        if (!p.regex.matchView(line).hasMatch()) continue;
+
+        if (p.action == PatternAction::Ready) {
+            m_ready = true;
+        } else if (p.action == PatternAction::Highlight) {
+            ++highlights;
+            continue;
+        }
+        if (hits.size() < MaxHitsPerFeed) {
+            hits.append({ i, p.action, line.toString() });
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QList>
+#include <QMetaType>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringDecoder>
+
+// 匹配到输出模式后的动作
+enum class PatternAction {
+    Ready = 0,       // 标记命令已就绪
+    Highlight = 1,   // 在输出窗口中高亮该行
+    Notify = 2       // 通过托盘发出通知
+};
+
+struct OutputPattern {
+    QString pattern;
+    PatternAction action = PatternAction::Highlight;
+};
+
+struct PatternHit {
+    int index = 0;   // 命中的模式序号
+    PatternAction action = PatternAction::Highlight;
+    QString line;
+};
+Q_DECLARE_METATYPE(PatternHit)
+
+// 在输出流上增量匹配一组预编译的正则：每次只处理新到达的文本，
+// 未结束的行暂存到下一次，因此跨越读取边界的行也能完整匹配。
+// 标准输出和标准错误各自由有状态的解码器解码并保存不完整的行：被读取边界切开的
+// 多字节字符会留到下一次，交错到达的两个流也不会拼成一行。
+// 匹配前去掉 ANSI 转义序列，带颜色的输出与纯文本按同样的内容匹配。
+// 每行最多参与匹配 MaxLineLength 个字符，单次处理的开销与新增文本长度成正比
+class PatternMatcher {
+public:
+    static constexpr qsizetype MaxLineLength = 4096;
+    static constexpr int MaxHitsPerFeed = 32;   // 单次最多报告的命中（高亮只计数）
+    static constexpr int StreamCount = 2;       // 0 标准输出，1 标准错误
+
+    explicit PatternMatcher(const QList<OutputPattern>& patterns);
+
+    bool isEmpty() const { return m_patterns.isEmpty(); }
+
+    // 返回 stream 上新到达数据中完整行的命中；highlights 累加高亮命中的行数
+    QList<PatternHit> feed(int stream, QByteArrayView data, int& highlights);
+    QList<PatternHit> finish(int& highlights);   // 进程结束时处理各个流最后不完整的一行
+
+private:
+    struct Compiled {
+        QRegularExpression regex;
+        PatternAction action;
+    };
+
+    struct Stream {
+        QStringDecoder decoder;   // 被读取边界切开的多字节字符留到下一次
+        QString carry;            // 上次剩下的不完整行
+    };
+
+    void matchLine(QStringView line, QList<PatternHit>& hits, int& highlights, bool partial);
+
+    QList<Compiled> m_patterns;
+    Stream m_streams[StreamCount];
+    bool m_ready = false;     // 就绪只报告一次，两个流共用
+};
@@ -0,0 +1,310 @@
+#include "OutputSearch.h"
+#include "CommandManager.h"
+#include "AnsiText.h"
+#include "Tracing.h"
+#include <QRegularExpression>
+#include <cstring>
+
+namespace {
+
+// 日志文本中字节出现频率的粗略排序，数值越大越常见
+int byteRank(uchar c) {
+    static const char letters[] = "etaoinshrdlcumwfgypbvkjxqz";
+    if (c == ' ') return 100;
+    if (c >= 'a' && c <= 'z') {
+        return 90 - int(std::strchr(letters, c) - letters) * 3;
+    }
+    if (c >= '0' && c <= '9') return 40;
+    if (c >= 'A' && c <= 'Z') return 20;
+    return 10;
+}
+
+QByteArray encodeQuery(const QString& query) {
+#ifdef Q_OS_WIN
+    return query.toLocal8Bit();
+#else
+    return query.toUtf8();
+#endif
+}
+
+quint64 s_nextSearchId = 0;   // 只在界面线程中分配
+
+}
+
+qsizetype SearchWorker::findLiteral(QByteArrayView haystack, QByteArrayView needle, qsizetype from) {
+    const qsizetype n = needle.size();
+    if (n == 0 || from < 0 || haystack.size() - from < n) return -1;
+
+    // 用 memchr 跳到针串中最少见的字节，减少逐字节比较的次数
+    qsizetype rare = 0;
+    for (qsizetype i = 1; i < n; ++i) {
+        if (byteRank(uchar(needle[i])) < byteRank(uchar(needle[rare]))) rare = i;
+    }
+
+    const char* data = haystack.data();
+    qsizetype pos = from + rare;
+    const qsizetype last = haystack.size() - n + rare;
+    while (pos <= last) {
+        const void* hit = std::memchr(data + pos, needle[rare], size_t(last - pos + 1));
+        if (!hit) return -1;
+        qsizetype at = static_cast<const char*>(hit) - data;
+        qsizetype start = at - rare;
+        if (std::memcmp(data + start, needle.data(), size_t(n)) == 0) return start;
+        pos = at + 1;
+    }
+    return -1;
+}
+
+void SearchWorker::search(const SearchRequest& request) {
+    TRACE_SCOPE("SearchWorker::search");
+    if (isCancelled(request)) return;
+    if (request.regex) {
+        searchRegex(request);
+    } else {
+        searchLiteral(request);
+    }
+}
+
+void SearchWorker::searchLiteral(const SearchRequest& request) {
+    const OutputSnapshot& snapshot = request.snapshot;
+    QByteArray needle = encodeQuery(request.query);
+    if (!request.caseSensitive) needle = needle.toLower();
+    const qint64 overlap = needle.size() - 1;
+    qint64 budget = request.maxOffsets;
+
+    qint64 pos = snapshot.begin;
+    while (pos < snapshot.end) {
+        if (isCancelled(request)) return;
+        TRACE_SCOPE("SearchWorker::literalStep");
+
+        // 每一步多读 overlap 个字节，跨越步长边界的匹配也能找到
+        qint64 stepEnd = qMin(snapshot.end, pos + StepBytes);
+        QByteArray window = snapshot.mid(pos, stepEnd - pos + overlap);
+        if (!request.caseSensitive) window = std::move(window).toLower();   // 只折叠 ASCII 大小写
+
+        QList<qint64> offsets;
+        qint64 extra = 0;
+        const qsizetype limit = qsizetype(stepEnd - pos);
+        for (qsizetype i = findLiteral(window, needle, 0); i >= 0 && i < limit;
+             i = findLiteral(window, needle, i + needle.size())) {
+            if (budget > 0) {
+                offsets.append(pos + i);
+                --budget;
+            } else {
+                ++extra;
+            }
+        }
+        TRACE_COUNT("SearchWorker::scannedBytes", stepEnd - pos);
+        pos = stepEnd;
+        emit progress(request.id, offsets, extra, pos);
+    }
+    emit finished(request.id, pos);
+}
+
+void SearchWorker::searchRegex(const SearchRequest& request) {
+    const OutputSnapshot& snapshot = request.snapshot;
+    QRegularExpression regex(request.query, request.caseSensitive ? QRegularExpression::NoPatternOption
+                                                                  : QRegularExpression::CaseInsensitiveOption);
+    regex.optimize();
+    qint64 budget = request.maxOffsets;
+
+    qint64 pos = snapshot.begin;
+    qint64 scannedTo = pos;
+    while (pos < snapshot.end) {
+        if (isCancelled(request)) return;
+        TRACE_SCOPE("SearchWorker::regexStep");
+
+        // 只处理完整的行；单行超过一步时整段作为一行处理
+        QByteArray window = snapshot.mid(pos, StepBytes);
+        if (pos + window.size() < snapshot.end) {
+            qsizetype cut = window.lastIndexOf('\n');
+            if (cut >= 0) window.truncate(cut + 1);
+        }
+
+        QList<qint64> offsets;
+        qint64 extra = 0;
+        qsizetype lastLine = 0;
+        qsizetype start = 0;
+        while (start < window.size()) {
+            qsizetype newline = window.indexOf('\n', start);
+            qsizetype stop = newline < 0 ? window.size() : newline;
+            QString line = Ansi::plainText(QByteArrayView(window).sliced(start, stop - start));
+            if (regex.matchView(line).hasMatch()) {
+                if (budget > 0) {
+                    offsets.append(pos + start);
+                    --budget;
+                } else {
+                    ++extra;
+                }
+            }
+            lastLine = start;
+            start = stop + 1;
+        }
+
+        TRACE_COUNT("SearchWorker::scannedBytes", window.size());
+        // 快照末尾不完整的行之后还会变长，下一次从它的行首重新搜索
+        scannedTo = window.endsWith('\n') ? pos + window.size() : pos + lastLine;
+        pos += window.size();
+        emit progress(request.id, offsets, extra, scannedTo);
+    }
+    emit finished(request.id, scannedTo);
+}
+
+OutputSearch::OutputSearch(CommandEntry* entry, SearchWorker* worker, QObject* parent)
+    : QObject(parent), m_entry(entry), m_worker(worker) {
+    m_followTimer.setSingleShot(true);
+    m_followTimer.setInterval(FollowInterval);
+    connect(&m_followTimer, &QTimer::timeout, this, &OutputSearch::dispatch);
+    connect(worker, &SearchWorker::progress, this, &OutputSearch::handleProgress);
+    connect(worker, &SearchWorker::finished, this, &OutputSearch::handleFinished);
+    connect(entry, &CommandEntry::outputChanged, this, &OutputSearch::handleOutputChanged);
+}
+
+OutputSearch::~OutputSearch() {
+    if (m_cancelled) m_cancelled->store(true);
+}
+
+qint64 OutputSearch::currentRow() const {
+    if (!m_entry || m_current <= 0 || size_t(m_current) > m_offsets.size()) return -1;
+    return m_entry->outputBuffer().rowAtOffset(m_offsets[size_t(m_current - 1)]);
+}
+
+qint64 OutputSearch::scannedBytes() const {
+    if (!m_entry) return 0;
+    return qBound<qint64>(0, m_scannedTo - m_entry->outputStart(), totalBytes());
+}
+
+qint64 OutputSearch::totalBytes() const {
+    return m_entry ? m_entry->outputEnd() - m_entry->outputStart() : 0;
+}
+
+void OutputSearch::start(const QString& query, bool regex, bool caseSensitive) {
+    cancel();
+    m_offsets.clear();
+    m_extra = 0;
+    m_current = 0;
+    m_error.clear();
+    m_query = query;
+    m_regex = regex;
+    m_caseSensitive = caseSensitive;
+    m_scannedTo = m_entry ? m_entry->outputStart() : 0;
+
+    if (!m_query.isEmpty() && m_regex) {
+        QRegularExpression check(m_query);
+        if (!check.isValid()) {
+            m_error = check.errorString();
+            m_query.clear();
+        }
+    }
+    dispatch();
+    emit stateChanged();
+    emit currentChanged();
+}
+
+void OutputSearch::cancel() {
+    // 取消后不再跟随新输出，已找到的位置仍可以跳转
+    m_followTimer.stop();
+    m_query.clear();
+    if (m_cancelled) m_cancelled->store(true);
+    m_cancelled.reset();
+    m_id = 0;
+    if (m_running) {
+        m_running = false;
+        emit stateChanged();
+    }
+}
+
+void OutputSearch::dispatch() {
+    if (!m_entry || m_query.isEmpty() || m_running) return;
+    const OutputBuffer& buffer = m_entry->outputBuffer();
+    if (m_scannedTo >= buffer.endOffset()) return;
+
+    // 字面量可能跨越上次搜索的末尾，往回多取针串长度减一个字节；这部分之前不可能完整匹配过
+    qint64 from = m_scannedTo;
+    if (!m_regex) {
+        from -= encodeQuery(m_query).size() - 1;
+    }
+
+    SearchRequest request;
+    request.id = ++s_nextSearchId;
+    request.snapshot = buffer.snapshot(from);
+    request.query = m_query;
+    request.regex = m_regex;
+    request.caseSensitive = m_caseSensitive;
+    request.maxOffsets = qMax<qint64>(0, MaxOffsets - qint64(m_offsets.size()));
+    request.cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    m_id = request.id;
+    m_cancelled = request.cancelled;
+    m_running = true;
+    SearchWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, request]() { worker->search(request); });
+    emit stateChanged();
+}
+
+void OutputSearch::handleProgress(quint64 id, const QList<qint64>& offsets, qint64 extra, qint64 scannedTo) {
+    if (id != m_id) return;
+    qint64 start = m_entry ? m_entry->outputStart() : 0;
+    for (qint64 offset : offsets) {
+        // 跳过搜索期间已被淘汰的位置，以及重新搜索不完整行时重复报告的位置
+        if (offset < start || (!m_offsets.empty() && offset <= m_offsets.back())) continue;
+        m_offsets.push_back(offset);
+    }
+    m_extra += extra;
+    m_scannedTo = qMax(m_scannedTo, scannedTo);
+    emit stateChanged();
+}
+
+void OutputSearch::handleFinished(quint64 id, qint64 scannedTo) {
+    if (id != m_id) return;
+    m_running = false;
+    m_cancelled.reset();
+    m_scannedTo = qMax(m_scannedTo, scannedTo);
+    emit stateChanged();
+
+    // 搜索期间到达的新输出
+    if (m_entry && m_scannedTo < m_entry->outputEnd()) {
+        m_followTimer.start();
+    }
+}
+
+void OutputSearch::handleOutputChanged() {
+    pruneEvicted();
+    if (!m_query.isEmpty() && !m_running && !m_followTimer.isActive()) {
+        m_followTimer.start();
+    }
+}
+
+void OutputSearch::pruneEvicted() {
+    if (!m_entry) return;
+    qint64 start = m_entry->outputStart();
+    int removed = 0;
+    while (!m_offsets.empty() && m_offsets.front() < start) {
+        m_offsets.pop_front();
+        ++removed;
+    }
+    m_scannedTo = qMax(m_scannedTo, start);
+    if (removed > 0) {
+        m_current = qMax(0, m_current - removed);
+        emit stateChanged();
+        emit currentChanged();
+    }
+}
+
+qint64 OutputSearch::next() {
+    pruneEvicted();
+    int count = int(m_offsets.size());
+    if (count == 0) return -1;
+    m_current = m_current >= count ? 1 : m_current + 1;
+    emit currentChanged();
+    return currentRow();
+}
+
+qint64 OutputSearch::previous() {
+    pruneEvicted();
+    int count = int(m_offsets.size());
+    if (count == 0) return -1;
+    m_current = m_current <= 1 ? count : m_current - 1;
+    emit currentChanged();
+    return currentRow();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include "OutputBuffer.h"
+
+class CommandEntry;
+
+struct SearchRequest {
+    quint64 id = 0;
+    OutputSnapshot snapshot;
+    QString query;
+    bool regex = false;
+    bool caseSensitive = false;
+    qint64 maxOffsets = 0;   // 最多回传的位置数，超过部分只计数
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+// 运行在独立线程中的输出搜索。内容来自 OutputBuffer 的快照，不阻塞界面线程；
+// 每扫描 StepBytes 报告一次进度，取消标志在每一步之间检查。
+// 字面量按原始字节查找：用 memchr（glibc 中为向量化实现）定位针串中最少见的字节，再逐一比较；
+// 正则按行解码、去掉转义序列后匹配，每行最多报告一次
+class SearchWorker : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 StepBytes = 4 * 1024 * 1024;
+
+    explicit SearchWorker(QObject* parent = nullptr) : QObject(parent) {}
+
+    void search(const SearchRequest& request);
+    void stop() { m_stopping.store(true); }   // 程序退出时中断正在进行的搜索
+
+    // 在 haystack 的 [from, end) 中查找 needle，返回位置或 -1
+    static qsizetype findLiteral(QByteArrayView haystack, QByteArrayView needle, qsizetype from);
+
+signals:
+    // offsets 为本批新找到的匹配位置（绝对偏移，升序），extra 为超出回传上限而只计数的匹配数；
+    // scannedTo 之前的内容已搜索完毕，追加搜索从这里继续
+    void progress(quint64 id, const QList<qint64>& offsets, qint64 extra, qint64 scannedTo);
+    void finished(quint64 id, qint64 scannedTo);
+
+private:
+    bool isCancelled(const SearchRequest& request) const {
+        return m_stopping.load(std::memory_order_relaxed) || request.cancelled->load(std::memory_order_relaxed);
+    }
+    void searchLiteral(const SearchRequest& request);
+    void searchRegex(const SearchRequest& request);
+
+    std::atomic<bool> m_stopping{ false };
+};
+
+// 一个命令的输出搜索状态，暴露给输出窗口。搜索完成后新到达的输出会被增量搜索
+class OutputSearch : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY stateChanged)
+    Q_PROPERTY(qint64 matchCount READ matchCount NOTIFY stateChanged)
+    Q_PROPERTY(int current READ current NOTIFY currentChanged)         // 当前匹配序号，从 1 开始，0 表示没有
+    Q_PROPERTY(qint64 currentRow READ currentRow NOTIFY currentChanged) // 当前匹配所在的 LogModel 行，-1 表示没有
+    Q_PROPERTY(qint64 scannedBytes READ scannedBytes NOTIFY stateChanged)
+    Q_PROPERTY(qint64 totalBytes READ totalBytes NOTIFY stateChanged)
+    Q_PROPERTY(QString error READ error NOTIFY stateChanged)
+
+public:
+    static constexpr qint64 MaxOffsets = 1000000;   // 保留用于跳转的匹配位置上限
+    static constexpr int FollowInterval = 100;      // 新输出的增量搜索合并间隔（毫秒）
+
+    OutputSearch(CommandEntry* entry, SearchWorker* worker, QObject* parent = nullptr);
+    ~OutputSearch() override;
+
+    bool running() const { return m_running; }
+    qint64 matchCount() const { return qint64(m_offsets.size()) + m_extra; }
+    int current() const { return m_current; }
+    qint64 currentRow() const;
+    qint64 scannedBytes() const;
+    qint64 totalBytes() const;
+    QString error() const { return m_error; }
+
+    // 清空上一次结果并从头搜索；query 为空时只清空
+    Q_INVOKABLE void start(const QString& query, bool regex, bool caseSensitive);
+    Q_INVOKABLE void cancel();
+    // 移动到下一个/上一个匹配并返回其所在行，没有匹配时返回 -1
+    Q_INVOKABLE qint64 next();
+    Q_INVOKABLE qint64 previous();
+
+signals:
+    void stateChanged();
+    void currentChanged();
+
+private:
+    void dispatch();
+    void handleProgress(quint64 id, const QList<qint64>& offsets, qint64 extra, qint64 scannedTo);
+    void handleFinished(quint64 id, qint64 scannedTo);
+    void handleOutputChanged();
+    void pruneEvicted();
+
+    QPointer<CommandEntry> m_entry;
+    SearchWorker* m_worker;
+    QTimer m_followTimer;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    quint64 m_id = 0;
+    QString m_query;
+    bool m_regex = false;
+    bool m_caseSensitive = false;
+    bool m_running = false;
+    QString m_error;
+    std::deque<qint64> m_offsets;
+    qint64 m_extra = 0;
+    qint64 m_scannedTo = 0;
+    int m_current = 0;
+};
@@ -0,0 +1,173 @@
+#include "ProcessMetrics.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+// 直接用系统调用读取 /proc 小文件，避免 QFile 的额外分配
+int readSmallFile(const char* path, char* buffer, int size) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = ::read(fd, buffer, size - 1);
+    ::close(fd);
+    if (n < 0) return -1;
+    buffer[n] = '\0';
+    return int(n);
+}
+
+qint64 fieldValue(const char* text, const char* key) {
+    const char* p = strstr(text, key);
+    return p ? strtoll(p + strlen(key), nullptr, 10) : 0;
+}
+#endif
+}
+
+ProcessSampler::ProcessSampler() {
+    m_clock.start();
+#ifdef Q_OS_LINUX
+    m_ticksPerSecond = qMax<long>(1, sysconf(_SC_CLK_TCK));
+    m_pageKb = qMax<long>(1, sysconf(_SC_PAGESIZE) / 1024);
+#endif
+}
+
+void ProcessSampler::track(quint64 runId, qint64 pid) {
+    Tracked tracked;
+    tracked.pid = pid;
+    tracked.totals.runId = runId;
+    m_runs.insert(runId, tracked);
+}
+
+void ProcessSampler::untrack(quint64 runId) {
+    m_runs.remove(runId);
+}
+
+QList<ProcessMetrics> ProcessSampler::sample() {
+    QList<ProcessMetrics> result;
+#ifdef Q_OS_LINUX
+    qint64 now = m_clock.nsecsElapsed();
+    QList<qint64> pids;
+
+    for (Tracked& run : m_runs) {
+        pids.clear();
+        collectTree(run.pid, pids);
+
+        QHash<qint64, Counters> current;
+        current.reserve(pids.size());
+        qint64 deltaTicks = 0;
+        qint64 rssKb = 0;
+        int threads = 0;
+
+        for (qint64 pid : pids) {
+            Counters counters;
+            qint64 processRss = 0;
+            int processThreads = 0;
+            if (!readProcess(pid, counters, processRss, processThreads)) continue;
+
+            // 新出现的子进程整个计入增量；已退出的进程不再出现，之前的累计保留
+            Counters previous = run.last.value(pid);
+            deltaTicks += qMax<qint64>(0, counters.ticks - previous.ticks);
+            run.totals.readBytes += qMax<qint64>(0, counters.readBytes - previous.readBytes);
+            run.totals.writeBytes += qMax<qint64>(0, counters.writeBytes - previous.writeBytes);
+            rssKb += processRss;
+            threads += processThreads;
+            current.insert(pid, counters);
+        }
+
+        if (run.lastSampleNs >= 0 && now > run.lastSampleNs) {
+            double seconds = double(now - run.lastSampleNs) / 1e9;
+            run.totals.cpuPercent = 100.0 * double(deltaTicks) / double(m_ticksPerSecond) / seconds;
+        }
+        run.last = std::move(current);
+        run.lastSampleNs = now;
+
+        // 根进程的 VmHWM 能捕获两次采样之间的短暂峰值
+        char path[64];
+        char buffer[4096];
+        snprintf(path, sizeof(path), "/proc/%lld/status", static_cast<long long>(run.pid));
+        qint64 rootPeak = readSmallFile(path, buffer, sizeof(buffer)) > 0 ? fieldValue(buffer, "VmHWM:") : 0;
+
+        run.totals.rssKb = rssKb;
+        run.totals.peakRssKb = qMax(run.totals.peakRssKb, qMax(rssKb, rootPeak));
+        run.totals.processCount = int(run.last.size());
+        run.totals.threadCount = threads;
+        result.append(run.totals);
+    }
+#endif
+    return result;
+}
+
+void ProcessSampler::collectTree(qint64 pid, QList<qint64>& pids) {
+#ifdef Q_OS_LINUX
+    // children 文件只列出主线程创建的子进程，对 shell 包装的命令已经足够
+    qsizetype first = pids.size();
+    pids.append(pid);
+    char path[64];
+    char buffer[4096];
+    for (qsizetype i = first; i < pids.size(); ++i) {
+        snprintf(path, sizeof(path), "/proc/%lld/task/%lld/children",
+                 static_cast<long long>(pids[i]), static_cast<long long>(pids[i]));
+        if (readSmallFile(path, buffer, sizeof(buffer)) <= 0) continue;
+
+        char* cursor = buffer;
+        while (*cursor) {
+            char* end = nullptr;
+            long long child = strtoll(cursor, &end, 10);
+            if (end == cursor) break;
+            pids.append(child);
+            cursor = end;
+        }
+    }
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(pids);
+#endif
+}
+
+bool ProcessSampler::readProcess(qint64 pid, Counters& counters, qint64& rssKb, int& threads) const {
+#ifdef Q_OS_LINUX
+    char path[64];
+    char buffer[1024];
+    snprintf(path, sizeof(path), "/proc/%lld/stat", static_cast<long long>(pid));
+    if (readSmallFile(path, buffer, sizeof(buffer)) <= 0) return false;
+
+    // 进程名可能包含空格和括号，从最后一个 ')' 之后开始解析，第一个字段是第 3 项 state
+    char* cursor = strrchr(buffer, ')');
+    if (!cursor) return false;
+    cursor += 2;
+
+    qint64 utime = 0, stime = 0, rssPages = 0;
+    for (int field = 3; field <= 24 && *cursor; ++field) {
+        char* end = nullptr;
+        long long value = strtoll(cursor, &end, 10);
+        if (field == 14) utime = value;
+        else if (field == 15) stime = value;
+        else if (field == 20) threads = int(value);
+        else if (field == 24) rssPages = value;
+        cursor = strchr(cursor, ' ');
+        if (!cursor) break;
+        ++cursor;
+    }
+    counters.ticks = utime + stime;
+    rssKb = rssPages * m_pageKb;
+
+    // io 只对同一用户的进程可读，读取失败时按 0 处理
+    snprintf(path, sizeof(path), "/proc/%lld/io", static_cast<long long>(pid));
+    if (readSmallFile(path, buffer, sizeof(buffer)) > 0) {
+        counters.readBytes = fieldValue(buffer, "\nread_bytes:");
+        counters.writeBytes = fieldValue(buffer, "\nwrite_bytes:");
+    }
+    return true;
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(counters);
+    Q_UNUSED(rssKb);
+    Q_UNUSED(threads);
+    return false;
+#endif
+}
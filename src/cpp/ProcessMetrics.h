@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QElapsedTimer>
+
+// 一个命令（包括其全部子进程）在一次采样时的资源占用
+struct ProcessMetrics {
+    quint64 runId = 0;
+    double cpuPercent = 0;     // 相对单个核心，多核满载时可超过 100
+    qint64 rssKb = 0;          // 进程树常驻内存之和
+    qint64 peakRssKb = 0;      // 本次运行以来的峰值
+    qint64 readBytes = 0;      // 本次运行累计的磁盘读写，已退出的子进程也计入
+    qint64 writeBytes = 0;
+    int processCount = 0;
+    int threadCount = 0;
+};
+Q_DECLARE_METATYPE(ProcessMetrics)
+
+// 基于 /proc 的进程树采样器：每次采样只读取被跟踪进程树中每个进程的
+// stat、io 和 children 文件，开销与受管进程数成正比，与系统进程总数无关。
+// 非 Linux 平台上 sample() 返回空列表
+class ProcessSampler {
+public:
+    ProcessSampler();
+
+    void track(quint64 runId, qint64 pid);
+    void untrack(quint64 runId);
+    bool isEmpty() const { return m_runs.isEmpty(); }
+
+    QList<ProcessMetrics> sample();
+
+    // 把 pid 及其全部后代进程追加到 pids，父进程在前
+    static void collectTree(qint64 pid, QList<qint64>& pids);
+
+private:
+    struct Counters {
+        qint64 ticks = 0;
+        qint64 readBytes = 0;
+        qint64 writeBytes = 0;
+    };
+
+    struct Tracked {
+        qint64 pid = 0;
+        QHash<qint64, Counters> last;   // 上次采样时各进程的计数
+        ProcessMetrics totals;
+        qint64 lastSampleNs = -1;
+    };
+
+    bool readProcess(qint64 pid, Counters& counters, qint64& rssKb, int& threads) const;
+
+    QHash<quint64, Tracked> m_runs;
+    QElapsedTimer m_clock;
+    qint64 m_ticksPerSecond = 100;
+    qint64 m_pageKb = 4;
+};
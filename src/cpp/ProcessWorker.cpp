@@ -0,0 +1,415 @@
+#include "ProcessWorker.h"
+#include "Tracing.h"
+#include <QDebug>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int StopPollInterval = 50;   // 停止过程中检查进程树的间隔（毫秒）
+constexpr int KillGrace = 2000;        // SIGKILL 之后最多再等待的时间
+
+#ifdef Q_OS_UNIX
+// 僵尸进程已经退出，只是尚未被回收，不算存活
+bool isAlive(qint64 pid) {
+    if (::kill(pid_t(pid), 0) != 0) return false;
+#ifdef Q_OS_LINUX
+    QFile file(QString("/proc/%1/stat").arg(pid));
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray stat = file.read(512);
+        int end = stat.lastIndexOf(')');
+        if (end >= 0 && end + 2 < stat.size() && stat.at(end + 2) == 'Z') return false;
+    }
+#endif
+    return true;
+}
+#endif
+}
+
+ProcessWorker::ProcessWorker(QObject* parent)
+    : QObject(parent), m_flushTimer(new QTimer(this)), m_metricsTimer(new QTimer(this)) {
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &ProcessWorker::flushAll);
+    connect(m_metricsTimer, &QTimer::timeout, this, &ProcessWorker::sampleMetrics);
+}
+
+void ProcessWorker::startProcess(quint64 runId, const QString& program, const QStringList& arguments,
+                                 const QString& archivePath, const QList<OutputPattern>& patterns,
+                                 const QString& teePath, qint64 teeRotateBytes) {
+    TRACE_SCOPE("ProcessWorker::startProcess");
+    auto* process = new QProcess(this);
+    Run run{ process };
+    if (!archivePath.isEmpty()) {
+        run.archivePath = archivePath;
+        run.archive = new RunArchiveWriter();
+        if (!run.archive->open(archivePath)) {
+            delete run.archive;
+            run.archive = nullptr;
+        }
+    }
+    if (!patterns.isEmpty()) {
+        run.matcher = new PatternMatcher(patterns);
+    }
+    if (!teePath.isEmpty()) {
+        // 打开失败也保留，错误通过 teeStats 报告给界面
+        run.tee = new TeeWriter(teePath, teeRotateBytes);
+        run.tee->open();
+        run.teeTimer.start();
+    }
+    m_runs.insert(runId, run);
+
+#ifdef Q_OS_UNIX
+    // 子进程自成一个进程组（组号等于其 pid），停止时 kill(-pgid) 可以覆盖 shell 启动的所有后代
+    process->setChildProcessModifier([]() { ::setpgid(0, 0); });
+#endif
+
+    connect(process, &QProcess::started, this, [this, runId, process]() {
+        m_sampler.track(runId, process->processId());
+        if (m_metricsInterval > 0 && !m_metricsTimer->isActive()) {
+            m_metricsTimer->start(m_metricsInterval);
+        }
+        emit processStarted(runId, process->processId());
+    });
+
+    // 管道数据先进入待刷新缓冲，按帧合并后统一解码再发往界面线程
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, runId, process]() {
+        TRACE_SCOPE("ProcessWorker::readStdout");
+        queueOutput(runId, process->readAllStandardOutput(), OutputStream::Stdout);
+    });
+
+    connect(process, &QProcess::readyReadStandardError, this, [this, runId, process]() {
+        TRACE_SCOPE("ProcessWorker::readStderr");
+        queueOutput(runId, process->readAllStandardError(), OutputStream::Stderr);
+    });
+
+    connect(process, &QProcess::finished, this, [this, runId](int exitCode, QProcess::ExitStatus exitStatus) {
+        // 进程结束时立即刷新剩余输出，保证输出先于结束通知到达
+        flush(runId);
+        Run& run = m_runs[runId];
+        if (run.matcher) {
+            int highlights = 0;
+            emitMatches(runId, run.matcher->finish(highlights), highlights);
+        }
+        if (run.tee) {
+            run.tee->flush();
+            reportTee(runId, run, true);
+        }
+        qint64 outputBytes = run.archive ? run.archive->size() : 0;
+        // 先关闭归档，界面线程收到结束通知时文件已经完整，可以读取或删除
+        if (run.archive) {
+            run.archive->close();
+        }
+        emit processFinished(runId, exitCode, exitStatus, run.peakRssKb, outputBytes);
+        releaseRun(runId);
+    });
+
+    connect(process, &QProcess::errorOccurred, this, [this, runId, process](QProcess::ProcessError err) {
+        // 启动失败时不会再收到 finished 信号，需要在这里清理
+        if (err == QProcess::FailedToStart) {
+            emit processFailed(runId, process->errorString());
+            releaseRun(runId);
+        } else {
+            emit processError(runId, err);
+        }
+    });
+
+    process->start(program, arguments);
+}
+
+void ProcessWorker::stopProcess(quint64 runId, int timeout) {
+    QProcess* process = m_runs.value(runId).process;
+    if (!process || m_stops.contains(runId)) return;
+
+    Stop stop;
+    stop.pgid = process->processId();
+    stop.timeout = timeout;
+    stop.elapsed.start();
+    // 尚未真正启动的进程没有 pid，不能用 0 作为进程组（那会指向启动器自身）
+    if (stop.pgid > 0) {
+        ProcessSampler::collectTree(stop.pgid, stop.pids);
+    }
+
+    stop.timer = new QTimer(this);
+    connect(stop.timer, &QTimer::timeout, this, [this, runId]() { checkStop(runId); });
+    stop.timer->start(StopPollInterval);
+
+#ifdef Q_OS_UNIX
+    signalTree(stop, SIGTERM);
+#else
+    process->terminate();
+#endif
+    m_stops.insert(runId, stop);
+}
+
+void ProcessWorker::checkStop(quint64 runId) {
+    auto it = m_stops.find(runId);
+    if (it == m_stops.end()) return;
+    Stop& stop = *it;
+    QProcess* process = m_runs.value(runId).process;
+
+#ifdef Q_OS_UNIX
+    // 发出停止时进程还在启动中，拿到 pid 后补发信号
+    if (stop.pgid <= 0 && process && process->processId() > 0) {
+        stop.pgid = process->processId();
+        ProcessSampler::collectTree(stop.pgid, stop.pids);
+        signalTree(stop, stop.escalated ? SIGKILL : SIGTERM);
+    }
+    int alive = signalTree(stop, 0);
+#else
+    int alive = 0;
+#endif
+    // QProcess 尚未回收直接子进程时也视为存活
+    if (process && alive == 0) {
+        alive = 1;
+    }
+    qint64 elapsed = stop.elapsed.elapsed();
+
+    if (alive > 0 && !stop.escalated && elapsed >= stop.timeout) {
+        // 超时后重新收集仍存活进程的后代，再整体强制结束
+#ifdef Q_OS_UNIX
+        QList<qint64> pids;
+        for (qint64 pid : std::as_const(stop.pids)) {
+            if (pid > 0 && isAlive(pid) && !pids.contains(pid)) {
+                ProcessSampler::collectTree(pid, pids);
+            }
+        }
+        stop.pids = pids;
+        signalTree(stop, SIGKILL);
+#else
+        if (process) {
+            process->kill();
+        }
+#endif
+        stop.escalated = true;
+        return;
+    }
+
+    if (alive > 0 && elapsed < stop.timeout + KillGrace) return;
+
+    if (alive > 0) {
+        qWarning() << "Processes still alive after stop:" << alive;
+    }
+    bool escalated = stop.escalated;
+    stop.timer->deleteLater();
+    m_stops.erase(it);
+    emit processStopped(runId, elapsed, escalated, alive);
+}
+
+int ProcessWorker::signalTree(Stop& stop, int signal) {
+#ifdef Q_OS_UNIX
+    // 先对整个进程组发信号，再补上快照中调用 setsid 等离开了进程组的后代
+    bool groupAlive = stop.pgid > 0 && ::kill(pid_t(-stop.pgid), signal) == 0;
+    int alive = 0;
+    for (qint64 pid : std::as_const(stop.pids)) {
+        if (pid > 0 && isAlive(pid)) {
+            if (signal != 0) ::kill(pid_t(pid), signal);
+            ++alive;
+        }
+    }
+    return qMax(alive, groupAlive ? 1 : 0);
+#else
+    Q_UNUSED(stop);
+    Q_UNUSED(signal);
+    return 0;
+#endif
+}
+
+void ProcessWorker::killProcess(quint64 runId) {
+    if (QProcess* process = m_runs.value(runId).process) {
+#ifdef Q_OS_UNIX
+        if (process->processId() > 0) {
+            ::kill(pid_t(-process->processId()), SIGKILL);
+        }
+#endif
+        process->kill();
+    }
+}
+
+void ProcessWorker::discardRun(quint64 runId, const QString& archivePath) {
+    auto it = m_runs.find(runId);
+    if (it == m_runs.end()) {
+        if (!archivePath.isEmpty()) {
+            QFile::remove(archivePath);
+        }
+        return;
+    }
+    it->discardArchive = true;
+    killProcess(runId);
+}
+
+void ProcessWorker::setFlushSettings(int interval, int threshold) {
+    m_flushInterval = interval;
+    m_flushThreshold = threshold;
+}
+
+void ProcessWorker::setMetricsInterval(int interval) {
+    m_metricsInterval = interval;
+    if (interval <= 0) {
+        m_metricsTimer->stop();
+    } else if (!m_sampler.isEmpty()) {
+        m_metricsTimer->start(interval);
+    }
+}
+
+QList<RunSummary> ProcessWorker::shutdown() {
+    m_flushTimer->stop();
+    m_metricsTimer->stop();
+    QList<RunSummary> killed;
+    const QList<quint64> ids = m_runs.keys();
+    for (quint64 runId : ids) {
+        const Run& run = m_runs[runId];
+        run.process->disconnect(this);
+#ifdef Q_OS_UNIX
+        if (run.process->processId() > 0) {
+            ::kill(pid_t(-run.process->processId()), SIGKILL);
+        }
+#endif
+        run.process->kill();
+        run.process->waitForFinished(1000);
+        delete run.process;
+        if (run.discardArchive) {
+            delete run.archive;
+            QFile::remove(run.archivePath);
+            continue;
+        }
+        killed.append({ runId, run.peakRssKb, run.archive ? run.archive->size() : 0 });
+        delete run.archive;   // 析构时写出剩余内容
+        delete run.matcher;
+        delete run.tee;
+    }
+    m_runs.clear();
+    m_pendingRuns.clear();
+    for (Stop& stop : m_stops) {
+#ifdef Q_OS_UNIX
+        signalTree(stop, SIGKILL);
+#endif
+        delete stop.timer;
+    }
+    m_stops.clear();
+    return killed;
+}
+
+void ProcessWorker::queueOutput(quint64 runId, const QByteArray& data, OutputStream stream) {
+    auto it = m_runs.find(runId);
+    if (data.isEmpty() || it == m_runs.end()) return;
+    TRACE_COUNT("ProcessWorker::bytesRead", data.size());
+
+    // 归档写入原始字节，不受界面刷新合并和解码的影响
+    if (it->archive) {
+        it->archive->append(data);
+    }
+    // tee 同样直接转发原始字节，小块读取在 TeeWriter 中合并，随刷新一起写出
+    if (it->tee) {
+        it->tee->append(data);
+    }
+
+    // 模式按管道分别匹配，两个流交错到达时各自的不完整行不会混在一起；
+    // 命中先暂存，随这一批输出一起在刷新时发出
+    if (it->matcher) {
+        TRACE_SCOPE("PatternMatcher::feed");
+        QList<PatternHit> hits = it->matcher->feed(int(stream), data, it->pendingHighlights);
+        for (const PatternHit& hit : std::as_const(hits)) {
+            if (it->pendingHits.size() >= PatternMatcher::MaxHitsPerFeed) break;
+            it->pendingHits.append(hit);
+        }
+    }
+
+    if (it->pendingChunks == 0) {
+        m_pendingRuns.append(runId);
+    }
+    it->pending.append(data);
+    ++it->pendingChunks;
+
+    // 同一管道在同一毫秒内的连续读取合并为一段
+    qint64 now = OutputBuffer::monotonicMs();
+    if (!it->segments.isEmpty() && it->segments.last().stream == stream && it->segments.last().timestamp == now) {
+        it->segments.last().length += data.size();
+    } else {
+        it->segments.append({ data.size(), now, stream });
+    }
+
+    if (it->pending.size() >= m_flushThreshold) {
+        flush(runId);
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start(m_flushInterval);
+    }
+}
+
+void ProcessWorker::flush(quint64 runId) {
+    auto it = m_runs.find(runId);
+    if (it == m_runs.end() || it->pendingChunks == 0) return;
+    TRACE_SCOPE("ProcessWorker::flush");
+
+    QByteArray data = std::exchange(it->pending, QByteArray());
+    int chunks = std::exchange(it->pendingChunks, 0);
+    QList<OutputSegment> segments = std::exchange(it->segments, {});
+    m_pendingRuns.removeOne(runId);
+
+    QList<PatternHit> hits = std::exchange(it->pendingHits, {});
+    int highlights = std::exchange(it->pendingHighlights, 0);
+    emit outputReady(runId, data, segments, chunks);
+    emitMatches(runId, hits, highlights);
+
+    if (it->tee) {
+        it->tee->flush();
+        reportTee(runId, *it, false);
+    }
+}
+
+void ProcessWorker::reportTee(quint64 runId, Run& run, bool force) {
+    qint64 elapsed = run.teeTimer.elapsed();
+    if (!force && elapsed < TeeReportInterval) return;
+    qint64 bytes = run.tee->bytesWritten();
+    double mbPerSec = elapsed > 0 ? double(bytes - run.teeReported) * 1000.0 / elapsed / (1024.0 * 1024.0) : 0.0;
+    run.teeReported = bytes;
+    run.teeTimer.restart();
+    emit teeStats(runId, bytes, mbPerSec, run.tee->droppedBytes(), run.tee->errorString());
+}
+
+void ProcessWorker::emitMatches(quint64 runId, const QList<PatternHit>& hits, int highlights) {
+    if (!hits.isEmpty() || highlights > 0) {
+        emit patternsMatched(runId, hits, highlights);
+    }
+}
+
+void ProcessWorker::flushAll() {
+    const QList<quint64> runs = std::exchange(m_pendingRuns, {});
+    for (quint64 runId : runs) {
+        flush(runId);
+    }
+}
+
+void ProcessWorker::releaseRun(quint64 runId) {
+    Run run = m_runs.take(runId);
+    m_pendingRuns.removeOne(runId);
+    delete run.archive;
+    delete run.matcher;
+    delete run.tee;
+    if (run.discardArchive) {
+        QFile::remove(run.archivePath);
+    }
+    if (run.process) {
+        run.process->deleteLater();
+    }
+    m_sampler.untrack(runId);
+    if (m_sampler.isEmpty()) {
+        m_metricsTimer->stop();
+    }
+}
+
+void ProcessWorker::sampleMetrics() {
+    TRACE_SCOPE("ProcessWorker::sampleMetrics");
+    QList<ProcessMetrics> metrics = m_sampler.sample();
+    if (metrics.isEmpty()) return;
+
+    for (const ProcessMetrics& m : std::as_const(metrics)) {
+        auto it = m_runs.find(m.runId);
+        if (it != m_runs.end()) {
+            it->peakRssKb = m.peakRssKb;
+        }
+    }
+    emit metricsSampled(metrics);
+}
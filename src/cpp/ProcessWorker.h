@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "RunArchive.h"
+#include "ProcessMetrics.h"
+#include "OutputPatterns.h"
+#include "OutputBuffer.h"
+#include "TeeWriter.h"
+
+// 程序退出时被结束的运行，用于补写 runs 表中的结束信息
+struct RunSummary {
+    quint64 runId = 0;
+    qint64 peakRssKb = 0;
+    qint64 outputBytes = 0;
+};
+
+// 运行在独立线程中的进程监管者：负责 QProcess 的创建、管道读取和输出合并，
+// 界面线程只通过排队信号接收合并后的原始字节，解码推迟到查看时进行。
+// Unix 上每个命令在独立的进程组中启动，停止时向整个进程树发信号
+class ProcessWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ProcessWorker(QObject* parent = nullptr);
+
+public slots:
+    // archivePath 非空时把原始输出同时写入压缩归档；patterns 在输出流上增量解码并匹配；
+    // teePath 非空时原始输出同时转发到该文件或 FIFO，teeRotateBytes > 0 时按大小轮转
+    void startProcess(quint64 runId, const QString& program, const QStringList& arguments,
+                      const QString& archivePath = QString(),
+                      const QList<OutputPattern>& patterns = QList<OutputPattern>(),
+                      const QString& teePath = QString(), qint64 teeRotateBytes = 0);
+    // 先发送 SIGTERM，timeout 毫秒后仍有后代进程存活则发送 SIGKILL，
+    // 确认整个进程树都已退出后发出 processStopped
+    void stopProcess(quint64 runId, int timeout);
+    void killProcess(quint64 runId);
+    // 命令被删除时使用：结束进程，归档写完关闭后删除文件；进程已结束时直接删除 archivePath
+    void discardRun(quint64 runId, const QString& archivePath);
+    void setFlushSettings(int interval, int threshold);
+    void setMetricsInterval(int interval);   // <= 0 表示停止采样
+    // 结束所有进程，需在工作线程退出前调用；返回被结束的运行
+    QList<RunSummary> shutdown();
+
+signals:
+    void processStarted(quint64 runId, qint64 pid);
+    void processFailed(quint64 runId, const QString& error);   // 启动失败，不会再有 finished
+    void processError(quint64 runId, int error);
+    void processFinished(quint64 runId, int exitCode, int exitStatus, qint64 peakRssKb, qint64 outputBytes);
+    // segments 按顺序划分 data，记录每一段的来源管道和读取时间
+    void outputReady(quint64 runId, const QByteArray& data, const QList<OutputSegment>& segments, int chunks);
+    void metricsSampled(const QList<ProcessMetrics>& metrics);
+    // 紧随对应的 outputReady 发出；highlights 为本批输出中命中高亮模式的行数
+    void patternsMatched(quint64 runId, const QList<PatternHit>& hits, int highlights);
+    // elapsedMs 为从发出停止到进程树全部退出的实际耗时，survivors 为放弃等待时仍存活的进程数
+    void processStopped(quint64 runId, qint64 elapsedMs, bool escalated, int survivors);
+    // tee 转发统计，每秒最多一次，进程结束前再发一次；mbPerSec 为上次报告以来的平均速率
+    void teeStats(quint64 runId, qint64 bytes, double mbPerSec, qint64 dropped, const QString& error);
+
+private:
+    struct Run {
+        QProcess* process = nullptr;
+        QByteArray pending;      // 等待合并刷新的原始输出
+        int pendingChunks = 0;   // pending 中累计的读取次数
+        QList<OutputSegment> segments;   // pending 中各段的来源和读取时间
+        RunArchiveWriter* archive = nullptr;
+        QString archivePath;
+        bool discardArchive = false;   // 释放时删除归档文件
+        qint64 peakRssKb = 0;    // 进程树运行期间采样到的内存峰值
+        PatternMatcher* matcher = nullptr;
+        QList<PatternHit> pendingHits;   // pending 对应的模式命中，刷新时随输出一起发出
+        int pendingHighlights = 0;
+        TeeWriter* tee = nullptr;
+        QElapsedTimer teeTimer;  // 上次报告 tee 统计以来的时间
+        qint64 teeReported = 0;  // 上次报告时已写出的字节数
+    };
+
+    void queueOutput(quint64 runId, const QByteArray& data, OutputStream stream);
+    struct Stop {
+        qint64 pgid = 0;
+        QList<qint64> pids;      // 停止开始时的进程树快照，包括离开了进程组的后代
+        QElapsedTimer elapsed;
+        QTimer* timer = nullptr;
+        int timeout = 3000;
+        bool escalated = false;
+    };
+
+    void checkStop(quint64 runId);
+    int signalTree(Stop& stop, int signal);   // 返回仍存活的进程数
+    void flush(quint64 runId);
+    void reportTee(quint64 runId, Run& run, bool force);
+    void emitMatches(quint64 runId, const QList<PatternHit>& hits, int highlights);
+    void flushAll();
+    void releaseRun(quint64 runId);
+    void sampleMetrics();
+
+    QHash<quint64, Run> m_runs;
+    QHash<quint64, Stop> m_stops;
+    QList<quint64> m_pendingRuns;
+    QTimer* m_flushTimer;
+    QTimer* m_metricsTimer;
+    ProcessSampler m_sampler;
+    int m_metricsInterval = 1000;
+    int m_flushInterval = 16;               // 约一帧
+    int m_flushThreshold = 256 * 1024;
+    static constexpr int TeeReportInterval = 1000;   // tee 统计的报告间隔（毫秒）
+};
@@ -0,0 +1,86 @@
+#include "RestartSupervisor.h"
+#include "CommandManager.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QTimer>
+
+RestartSupervisor::RestartSupervisor(CommandManager* manager, QObject* parent)
+    : QObject(parent), m_manager(manager) {}
+
+int RestartSupervisor::backoffDelay(int attempt) {
+    qint64 delay = BaseDelay;
+    for (int i = 0; i < attempt && delay < MaxDelay; ++i) {
+        delay *= 2;
+    }
+    delay = qMin<qint64>(delay, MaxDelay);
+
+    // ±20% 抖动，避免一批命令同时崩溃后又同时重启
+    double jitter = 0.8 + 0.4 * QRandomGenerator::global()->generateDouble();
+    return int(delay * jitter);
+}
+
+void RestartSupervisor::processExited(CommandEntry* entry, int exitCode, int exitStatus, bool userStopped) {
+    bool crashed = exitStatus == QProcess::CrashExit;
+    entry->setLastExitReason(crashed ? QString("崩溃 (退出码 %1)").arg(exitCode)
+                                     : QString("退出码 %1").arg(exitCode));
+
+    bool failed = crashed || exitCode != 0;
+    if (userStopped || entry->restartPolicy == RestartPolicy::Never ||
+        (entry->restartPolicy == RestartPolicy::OnFailure && !failed)) {
+        cancel(entry);
+        return;
+    }
+
+    State& state = m_states[entry];
+    state.entry = entry;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // 稳定运行过一段时间后重新从最短的等待开始
+    if (now - entry->runStartedAt >= StableRunTime) {
+        state.attempt = 0;
+    }
+    while (!state.restarts.empty() && now - state.restarts.front() > CrashLoopWindow) {
+        state.restarts.pop_front();
+    }
+    if (int(state.restarts.size()) >= CrashLoopLimit) {
+        qWarning() << "Crash loop detected, auto restart parked:" << entry->name();
+        if (state.timer) state.timer->stop();
+        entry->setRestartPending(false);
+        entry->setRestartParked(true);
+        return;
+    }
+
+    int delay = backoffDelay(state.attempt++);
+    state.restarts.push_back(now);
+    if (!state.timer) {
+        state.timer = new QTimer(this);
+        state.timer->setSingleShot(true);
+        connect(state.timer, &QTimer::timeout, this, [this, entry]() {
+            auto it = m_states.find(entry);
+            if (it == m_states.end() || !it->entry || it->entry->isActive()) return;
+
+            entry->setRestartPending(false);
+            entry->incrementRestartCount();
+            qDebug() << "Auto restarting command:" << entry->name();
+            m_manager->restartCommand(entry->id());
+        });
+    }
+    state.timer->start(delay);
+    entry->setRestartPending(true);
+    qDebug() << "Command exited, restarting in" << delay << "ms:" << entry->name();
+}
+
+void RestartSupervisor::reset(CommandEntry* entry) {
+    cancel(entry);
+    entry->setRestartParked(false);
+}
+
+void RestartSupervisor::cancel(CommandEntry* entry) {
+    auto it = m_states.find(entry);
+    if (it != m_states.end()) {
+        delete it->timer;
+        m_states.erase(it);
+    }
+    entry->setRestartPending(false);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <deque>
+
+class CommandManager;
+class CommandEntry;
+class QTimer;
+
+// 命令退出后的自动重启策略
+enum class RestartPolicy {
+    Never = 0,
+    OnFailure = 1,   // 非零退出码或崩溃时重启
+    Always = 2
+};
+
+// 自动重启：按指数退避并加随机抖动延迟重启；
+// 在时间窗口内重启次数过多时判定为崩溃循环并暂停，直到用户手动启动
+class RestartSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int BaseDelay = 1000;           // 第一次重启前等待的毫秒数
+    static constexpr int MaxDelay = 60 * 1000;
+    static constexpr int StableRunTime = 30 * 1000;  // 运行超过这个时间视为稳定，退避重新开始
+    static constexpr int CrashLoopLimit = 5;         // 窗口内最多允许的重启次数
+    static constexpr int CrashLoopWindow = 60 * 1000;
+
+    explicit RestartSupervisor(CommandManager* manager, QObject* parent = nullptr);
+
+    // 进程退出时调用；userStopped 表示由用户主动停止，此时不重启
+    void processExited(CommandEntry* entry, int exitCode, int exitStatus, bool userStopped);
+    // 用户手动启动或停止时调用：取消等待中的重启并清除崩溃循环状态
+    void reset(CommandEntry* entry);
+    void cancel(CommandEntry* entry);
+
+    static int backoffDelay(int attempt);   // 第 attempt 次连续重启前的等待时间（含抖动）
+
+private:
+    struct State {
+        QPointer<CommandEntry> entry;
+        QTimer* timer = nullptr;
+        int attempt = 0;                  // 连续重启次数，稳定运行后清零
+        std::deque<qint64> restarts;      // 窗口内的重启时间
+    };
+
+    CommandManager* m_manager;
+    QHash<CommandEntry*, State> m_states;
+};
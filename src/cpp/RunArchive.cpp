@@ -0,0 +1,174 @@
+#include "RunArchive.h"
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+constexpr char Magic[4] = { 'R', 'C', 'L', 'A' };
+constexpr quint32 Version = 1;
+constexpr qint64 HeaderSize = 8;
+constexpr qint64 SegmentHeaderSize = 8;
+}
+
+bool RunArchiveWriter::open(const QString& path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open run archive:" << path << m_file.errorString();
+        return false;
+    }
+
+    char header[HeaderSize];
+    memcpy(header, Magic, 4);
+    qToLittleEndian<quint32>(Version, header + 4);
+    m_file.write(header, HeaderSize);
+    m_size = 0;
+    return true;
+}
+
+void RunArchiveWriter::append(const QByteArray& data) {
+    if (!m_file.isOpen() || data.isEmpty()) return;
+
+    m_pending.append(data);
+    m_size += data.size();
+
+    // 尽量在换行处分段，浏览时段边界不会切开一行
+    while (m_pending.size() >= SegmentSize) {
+        qsizetype cut = m_pending.lastIndexOf('\n', SegmentSize - 1) + 1;
+        if (cut <= SegmentSize / 2) {
+            cut = SegmentSize;
+        }
+        writeSegment(m_pending.left(cut));
+        m_pending.remove(0, cut);
+    }
+}
+
+void RunArchiveWriter::close() {
+    if (!m_file.isOpen()) return;
+
+    if (!m_pending.isEmpty()) {
+        writeSegment(m_pending);
+        m_pending.clear();
+    }
+    m_file.close();
+}
+
+void RunArchiveWriter::writeSegment(const QByteArray& data) {
+    QByteArray compressed = qCompress(data, 1);
+
+    char header[SegmentHeaderSize];
+    qToLittleEndian<quint32>(quint32(data.size()), header);
+    qToLittleEndian<quint32>(quint32(compressed.size()), header + 4);
+    m_file.write(header, SegmentHeaderSize);
+    m_file.write(compressed);
+}
+
+bool RunArchiveReader::open(const QString& path) {
+    m_file.close();
+    m_file.setFileName(path);
+    m_segments.clear();
+    m_size = 0;
+    m_indexEnd = 0;
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = m_file.read(HeaderSize);
+    if (header.size() != HeaderSize || memcmp(header.constData(), Magic, 4) != 0) {
+        qWarning() << "Invalid run archive:" << path;
+        m_file.close();
+        return false;
+    }
+
+    m_indexEnd = HeaderSize;
+    refresh();
+    return true;
+}
+
+void RunArchiveReader::refresh() {
+    if (!m_file.isOpen()) return;
+
+    // 只读取各段头部建立索引，段数据在访问时才解压
+    qint64 position = m_indexEnd;
+    const qint64 fileSize = m_file.size();
+    while (position + SegmentHeaderSize <= fileSize) {
+        m_file.seek(position);
+        QByteArray segmentHeader = m_file.read(SegmentHeaderSize);
+        if (segmentHeader.size() != SegmentHeaderSize) break;
+
+        Segment segment;
+        segment.offset = m_size;
+        segment.position = position + SegmentHeaderSize;
+        segment.rawSize = qFromLittleEndian<quint32>(segmentHeader.constData());
+        segment.compressedSize = qFromLittleEndian<quint32>(segmentHeader.constData() + 4);
+        // 最后一段可能还在写入，或程序异常退出时没有写完，暂不索引
+        if (segment.position + segment.compressedSize > fileSize) break;
+
+        m_segments.append(segment);
+        m_size += segment.rawSize;
+        position = segment.position + segment.compressedSize;
+    }
+    m_indexEnd = position;
+}
+
+QByteArray RunArchiveReader::read(qint64 offset, qint64 length, bool* ok) const {
+    QByteArray result;
+    if (ok) *ok = true;
+    if (offset < 0 || offset >= m_size || length <= 0) return result;
+
+    qint64 end = qMin(m_size, offset + length);
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), offset,
+                               [](qint64 value, const Segment& s) { return value < s.offset; });
+    int index = int(it - m_segments.begin()) - 1;
+
+    result.reserve(end - offset);
+    for (; index < m_segments.size() && offset < end; ++index) {
+        const Segment& s = m_segments.at(index);
+        QByteArray data = segment(index);
+        if (data.isEmpty()) {
+            qWarning() << "Corrupt run archive segment:" << m_file.fileName() << index;
+            if (ok) *ok = false;
+            break;
+        }
+        qint64 from = offset - s.offset;
+        qint64 count = qMin<qint64>(data.size() - from, end - offset);
+        result.append(data.constData() + from, count);
+        offset += count;
+    }
+    return result;
+}
+
+QList<qint64> RunArchiveReader::search(const QByteArray& pattern, int maxResults, bool* ok,
+                                       const std::function<bool()>& cancelled) const {
+    QList<qint64> matches;
+    if (ok) *ok = true;
+    if (pattern.isEmpty()) return matches;
+
+    QByteArray carry;   // 上一段末尾不足以构成完整匹配的部分
+    for (int index = 0; index < m_segments.size(); ++index) {
+        if (cancelled && cancelled()) break;
+        QByteArray data = segment(index);
+        if (data.isEmpty()) {
+            qWarning() << "Corrupt run archive segment:" << m_file.fileName() << index;
+            if (ok) *ok = false;
+            break;
+        }
+        qint64 base = m_segments.at(index).offset - carry.size();
+        QByteArray window = carry + data;
+
+        for (qsizetype pos = window.indexOf(pattern); pos >= 0; pos = window.indexOf(pattern, pos + 1)) {
+            matches.append(base + pos);
+            if (matches.size() >= maxResults) return matches;
+        }
+        carry = window.right(pattern.size() - 1);
+    }
+    return matches;
+}
+
+QByteArray RunArchiveReader::segment(int index) const {
+    const Segment& s = m_segments.at(index);
+    m_file.seek(s.position);
+    QByteArray data = qUncompress(m_file.read(s.compressedSize));
+    // 段头记录的原始长度决定了偏移索引，长度不符时后面的定位都会出错
+    if (data.size() != qsizetype(s.rawSize)) return QByteArray();
+    return data;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <functional>
+
+// 运行输出归档：原始字节按段压缩写入文件，每段独立压缩，
+// 读取时只解压需要的段，因此可以随机定位和流式搜索而不必整个载入内存
+//
+// 文件格式：头部 "RCLA" + 版本号，之后是若干段，
+// 每段为 [原始长度 quint32][压缩长度 quint32][qCompress 数据]
+class RunArchiveWriter {
+public:
+    static constexpr qsizetype SegmentSize = 64 * 1024;   // 每段压缩前的字节数
+
+    RunArchiveWriter() = default;
+    ~RunArchiveWriter() { close(); }
+
+    bool open(const QString& path);
+    void append(const QByteArray& data);
+    void close();   // 写出剩余内容
+
+    bool isOpen() const { return m_file.isOpen(); }
+    qint64 size() const { return m_size; }   // 已写入的原始字节数
+
+private:
+    void writeSegment(const QByteArray& data);
+
+    QFile m_file;
+    QByteArray m_pending;
+    qint64 m_size = 0;
+};
+
+class RunArchiveReader {
+public:
+    bool open(const QString& path);
+    // 为 open 之后新写入的完整段补充索引，用于仍在写入的归档
+    void refresh();
+
+    QString path() const { return m_file.fileName(); }
+    qint64 size() const { return m_size; }
+    // 遇到损坏的段时停止，返回之前读到的内容并把 *ok 置为 false
+    QByteArray read(qint64 offset, qint64 length, bool* ok = nullptr) const;
+
+    // 逐段解压搜索，保留上一段末尾的重叠部分以匹配跨段内容；返回匹配的字节偏移。
+    // 遇到损坏的段时停止，*ok 置为 false；cancelled 在每段之间检查，返回 true 时中止
+    QList<qint64> search(const QByteArray& pattern, int maxResults = 1000, bool* ok = nullptr,
+                         const std::function<bool()>& cancelled = {}) const;
+
+private:
+    struct Segment {
+        qint64 offset;     // 段内第一个字节的原始偏移
+        qint64 position;   // 段数据在文件中的位置
+        quint32 rawSize;
+        quint32 compressedSize;
+    };
+
+    QByteArray segment(int index) const;   // 解压失败或长度不符时返回空
+
+    mutable QFile m_file;
+    QList<Segment> m_segments;
+    qint64 m_size = 0;
+    qint64 m_indexEnd = 0;   // 已建立索引的段之后的文件位置
+};
@@ -0,0 +1,208 @@
+#include "RunHistory.h"
+#include "CommandManager.h"
+#include "DatabaseWorker.h"
+#include "AnsiText.h"
+#include "Tracing.h"
+#include <QDebug>
+
+namespace {
+
+QByteArray encodePattern(const QString& pattern) {
+#ifdef Q_OS_WIN
+    return pattern.toLocal8Bit();
+#else
+    return pattern.toUtf8();
+#endif
+}
+
+quint64 s_nextRequestId = 0;   // 只在界面线程中分配
+
+}
+
+RunArchiveReader* RunArchiveWorker::reader(const QString& path) {
+    auto it = m_readers.find(path);
+    if (it != m_readers.end()) {
+        (*it)->refresh();
+        return it->get();
+    }
+
+    auto reader = std::make_shared<RunArchiveReader>();
+    if (!reader->open(path)) {
+        return nullptr;
+    }
+    m_readers.insert(path, reader);
+    return reader.get();
+}
+
+void RunArchiveWorker::read(quint64 id, const QString& path, qint64 offset, qint64 length) {
+    TRACE_SCOPE("RunArchiveWorker::read");
+    RunArchiveReader* archive = reader(path);
+    if (!archive) {
+        emit readFinished(id, offset, 0, QString(), false);
+        return;
+    }
+
+    bool ok = true;
+    QByteArray data = archive->read(offset, length, &ok);
+    // 不在文件末尾时截到最后一个换行，避免切开多字节字符，剩余部分由下一次读取返回
+    if (ok && offset + data.size() < archive->size()) {
+        qsizetype cut = data.lastIndexOf('\n');
+        if (cut >= 0) {
+            data.truncate(cut + 1);
+        }
+    }
+    emit readFinished(id, offset + data.size(), archive->size(), Ansi::plainText(data), ok);
+}
+
+void RunArchiveWorker::search(quint64 id, const QString& path, const QByteArray& pattern, int maxResults,
+                              const std::shared_ptr<std::atomic<bool>>& cancelled) {
+    auto isCancelled = [this, &cancelled]() {
+        return m_stopping.load(std::memory_order_relaxed) || cancelled->load(std::memory_order_relaxed);
+    };
+    if (isCancelled()) return;
+    TRACE_SCOPE("RunArchiveWorker::search");
+
+    RunArchiveReader* archive = reader(path);
+    if (!archive) {
+        emit searchFinished(id, {}, false);
+        return;
+    }
+
+    bool ok = true;
+    QList<qint64> offsets = archive->search(pattern, maxResults, &ok, isCancelled);
+    if (isCancelled()) return;
+    emit searchFinished(id, offsets, ok);
+}
+
+void RunArchiveWorker::release(const QString& path) {
+    m_readers.remove(path);
+}
+
+RunHistory::RunHistory(CommandEntry* entry, DatabaseWorker* store, RunArchiveWorker* worker,
+                       const QString& archiveDir, QObject* parent)
+    : QObject(parent), m_entry(entry), m_store(store), m_worker(worker), m_archiveDir(archiveDir) {
+    connect(store, &DatabaseWorker::runsLoaded, this, &RunHistory::handleRunsLoaded);
+    connect(worker, &RunArchiveWorker::readFinished, this, &RunHistory::handleReadFinished);
+    connect(worker, &RunArchiveWorker::searchFinished, this, &RunHistory::handleSearchFinished);
+}
+
+RunHistory::~RunHistory() {
+    close();
+}
+
+void RunHistory::reload() {
+    if (!m_entry) return;
+
+    // 数据库线程先提交排队的写入再读取，界面线程不等待
+    m_runsId = ++s_nextRequestId;
+    QMetaObject::invokeMethod(m_store, [store = m_store, id = m_runsId, name = m_entry->name()]() {
+        store->loadRuns(id, name, RunLimit);
+    });
+}
+
+void RunHistory::handleRunsLoaded(quint64 id, const QVariantList& runs) {
+    if (id != m_runsId) return;
+    m_runsId = 0;
+    m_runs = runs;
+    emit runsChanged();
+}
+
+void RunHistory::open(const QString& archive) {
+    find(QString());
+    if (!m_archive.isEmpty() && archive != m_archive && m_worker) {
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker.data(), path = archivePath()]() {
+            worker->release(path);
+        });
+    }
+
+    m_archive = archive;
+    m_readId = 0;
+    m_nextOffset = 0;
+    m_archiveSize = 0;
+    m_archiveError = false;
+    emit pageChanged();
+    emit pageLoaded(QString(), false);
+    if (!m_archive.isEmpty()) {
+        read(0, false);
+    }
+}
+
+void RunHistory::readFrom(qint64 offset) {
+    read(qMax<qint64>(0, offset), false);
+}
+
+void RunHistory::readMore() {
+    // 上一页还没返回时 nextOffset 尚未更新，不重复请求
+    if (m_readId != 0 || m_archiveError || m_nextOffset >= m_archiveSize) return;
+    read(m_nextOffset, true);
+}
+
+void RunHistory::read(qint64 offset, bool append) {
+    if (m_archive.isEmpty() || !m_worker) return;
+
+    m_readId = ++s_nextRequestId;
+    m_readAppend = append;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker.data(), id = m_readId, path = archivePath(), offset]() {
+        worker->read(id, path, offset, PageBytes);
+    });
+    emit pageChanged();
+}
+
+void RunHistory::handleReadFinished(quint64 id, qint64 next, qint64 size, const QString& text, bool ok) {
+    if (id != m_readId) return;
+    m_readId = 0;
+    m_nextOffset = next;
+    m_archiveSize = size;
+    m_archiveError = !ok;
+    emit pageLoaded(text, m_readAppend);
+    emit pageChanged();
+}
+
+void RunHistory::find(const QString& pattern) {
+    cancelSearch();
+    m_matches.clear();
+    m_searchError.clear();
+
+    if (!pattern.isEmpty() && !m_archive.isEmpty() && m_worker) {
+        m_searchId = ++s_nextRequestId;
+        m_cancelled = std::make_shared<std::atomic<bool>>(false);
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker.data(), id = m_searchId, path = archivePath(),
+                                             pattern = encodePattern(pattern), cancelled = m_cancelled]() {
+            worker->search(id, path, pattern, MaxMatches, cancelled);
+        });
+    }
+    emit searchChanged();
+}
+
+void RunHistory::cancelSearch() {
+    if (m_cancelled) m_cancelled->store(true);
+    m_cancelled.reset();
+    if (m_searchId != 0) {
+        m_searchId = 0;
+        emit searchChanged();
+    }
+}
+
+void RunHistory::handleSearchFinished(quint64 id, const QList<qint64>& offsets, bool ok) {
+    if (id != m_searchId) return;
+    m_searchId = 0;
+    m_cancelled.reset();
+    m_matches.reserve(offsets.size());
+    for (qint64 offset : offsets) {
+        m_matches.append(offset);
+    }
+    if (!ok) {
+        m_searchError = "归档无法读取或已损坏，结果只包含损坏位置之前的内容";
+    }
+    emit searchChanged();
+}
+
+void RunHistory::close() {
+    cancelSearch();
+    m_readId = 0;
+    if (!m_archive.isEmpty() && m_worker) {
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker.data(), path = archivePath()]() {
+            worker->release(path);
+        });
+    }
+}
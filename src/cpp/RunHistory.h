@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QVariant>
+#include <atomic>
+#include <memory>
+#include "RunArchive.h"
+
+class CommandEntry;
+class DatabaseWorker;
+
+// 运行在独立线程中的归档读取与搜索。每个正在查看的归档缓存一个已建立段索引的
+// RunArchiveReader，翻页时不必重新读取全部段头；归档仍在写入时只为新增的段补充索引
+class RunArchiveWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RunArchiveWorker(QObject* parent = nullptr) : QObject(parent) {}
+
+    // 读取 [offset, offset + length)，不在归档末尾时截到最后一个换行
+    void read(quint64 id, const QString& path, qint64 offset, qint64 length);
+    void search(quint64 id, const QString& path, const QByteArray& pattern, int maxResults,
+                const std::shared_ptr<std::atomic<bool>>& cancelled);
+    void release(const QString& path);        // 关闭缓存的归档
+    void stop() { m_stopping.store(true); }   // 程序退出时中断正在进行的搜索
+
+signals:
+    // ok 为 false 表示归档无法打开或中途遇到损坏的段，text/offsets 只包含此前的内容
+    void readFinished(quint64 id, qint64 next, qint64 size, const QString& text, bool ok);
+    void searchFinished(quint64 id, const QList<qint64>& offsets, bool ok);
+
+private:
+    RunArchiveReader* reader(const QString& path);
+
+    QHash<QString, std::shared_ptr<RunArchiveReader>> m_readers;   // 路径 -> 打开的归档
+    std::atomic<bool> m_stopping{ false };
+};
+
+// 一个命令的运行历史，暴露给运行历史窗口。运行记录由数据库线程读取，
+// 归档的分页读取和搜索在 RunArchiveWorker 中进行，结果都通过信号异步返回
+class RunHistory : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList runs READ runs NOTIFY runsChanged)
+    Q_PROPERTY(QString archive READ archive NOTIFY pageChanged)
+    Q_PROPERTY(qint64 nextOffset READ nextOffset NOTIFY pageChanged)
+    Q_PROPERTY(qint64 archiveSize READ archiveSize NOTIFY pageChanged)
+    Q_PROPERTY(bool archiveError READ archiveError NOTIFY pageChanged)
+    Q_PROPERTY(bool reading READ reading NOTIFY pageChanged)
+    Q_PROPERTY(bool searching READ searching NOTIFY searchChanged)
+    Q_PROPERTY(QVariantList matches READ matches NOTIFY searchChanged)   // 匹配的字节偏移，升序
+    Q_PROPERTY(QString searchError READ searchError NOTIFY searchChanged)
+
+public:
+    static constexpr int RunLimit = 50;             // 列表中显示的最近运行数
+    static constexpr qint64 PageBytes = 64 * 1024;  // 每次读取的字节数
+    static constexpr int MaxMatches = 1000;
+
+    RunHistory(CommandEntry* entry, DatabaseWorker* store, RunArchiveWorker* worker,
+               const QString& archiveDir, QObject* parent = nullptr);
+    ~RunHistory() override;
+
+    QVariantList runs() const { return m_runs; }
+    QString archive() const { return m_archive; }
+    qint64 nextOffset() const { return m_nextOffset; }
+    qint64 archiveSize() const { return m_archiveSize; }
+    bool archiveError() const { return m_archiveError; }
+    bool reading() const { return m_readId != 0; }
+    bool searching() const { return m_searchId != 0; }
+    QVariantList matches() const { return m_matches; }
+    QString searchError() const { return m_searchError; }
+
+    Q_INVOKABLE void reload();
+    // 切换查看的归档并读取第一页；archive 为空时只清空
+    Q_INVOKABLE void open(const QString& archive);
+    Q_INVOKABLE void readFrom(qint64 offset);   // 从 offset 读取一页，替换显示的内容
+    Q_INVOKABLE void readMore();                // 从 nextOffset 继续读取一页，追加到显示的内容
+    // 清空上一次结果并在当前归档中查找；pattern 为空时只清空
+    Q_INVOKABLE void find(const QString& pattern);
+    Q_INVOKABLE void cancelSearch();
+    Q_INVOKABLE void close();                   // 窗口关闭时释放归档
+
+signals:
+    void runsChanged();
+    void pageChanged();
+    void searchChanged();
+    void pageLoaded(const QString& text, bool append);
+
+private:
+    void read(qint64 offset, bool append);
+    void handleRunsLoaded(quint64 id, const QVariantList& runs);
+    void handleReadFinished(quint64 id, qint64 next, qint64 size, const QString& text, bool ok);
+    void handleSearchFinished(quint64 id, const QList<qint64>& offsets, bool ok);
+    QString archivePath() const { return m_archiveDir + "/" + m_archive; }
+
+    QPointer<CommandEntry> m_entry;
+    DatabaseWorker* m_store;
+    QPointer<RunArchiveWorker> m_worker;   // 程序退出时先于本对象销毁
+    QString m_archiveDir;
+    QVariantList m_runs;
+    quint64 m_runsId = 0;
+    QString m_archive;
+    quint64 m_readId = 0;
+    bool m_readAppend = false;
+    qint64 m_nextOffset = 0;
+    qint64 m_archiveSize = 0;
+    bool m_archiveError = false;
+    quint64 m_searchId = 0;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    QVariantList m_matches;
+    QString m_searchError;
+};
@@ -0,0 +1,178 @@
+#include "TeeWriter.h"
+#include "Tracing.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TeeWriter::TeeWriter(const QString& path, qint64 rotateBytes, int keep)
+    : m_path(path), m_rotateBytes(rotateBytes), m_keep(qMax(1, keep)) {}
+
+TeeWriter::~TeeWriter() {
+    flush();
+    closeTarget();
+}
+
+bool TeeWriter::open() {
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(m_path).constData(), &st) == 0 && S_ISFIFO(st.st_mode)) {
+        m_fifo = true;
+        // 读端关闭后写 FIFO 会收到 SIGPIPE，默认处理会结束整个程序，改为通过 EPIPE 处理
+        static const bool ignored = (::signal(SIGPIPE, SIG_IGN), true);
+        Q_UNUSED(ignored);
+        // 还没有读端不算错误，之后会定期重试
+        openFifo();
+        return true;
+    }
+#endif
+    return openFile();
+}
+
+bool TeeWriter::openFile() {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        m_error = m_file.errorString();
+        qWarning() << "Failed to open tee target:" << m_path << m_error;
+        return false;
+    }
+    m_fileSize = m_file.size();
+    return true;
+}
+
+bool TeeWriter::openFifo() {
+#ifdef Q_OS_UNIX
+    m_reopenTimer.start();
+    m_fd = ::open(QFile::encodeName(m_path).constData(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0 && errno != ENXIO) {
+        m_error = QString::fromLocal8Bit(std::strerror(errno));
+    }
+    return m_fd >= 0;
+#else
+    return false;
+#endif
+}
+
+void TeeWriter::closeTarget() {
+#ifdef Q_OS_UNIX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void TeeWriter::append(QByteArrayView data) {
+    m_buffer.append(data);
+    if (m_buffer.size() >= BufferSize) {
+        flush();
+    }
+}
+
+void TeeWriter::flush() {
+    if (m_buffer.isEmpty()) return;
+    TRACE_SCOPE("TeeWriter::flush");
+
+    if (m_fifo) {
+        if (m_fd < 0 && (!m_reopenTimer.isValid() || m_reopenTimer.elapsed() >= ReopenInterval)) {
+            openFifo();
+        }
+        if (m_fd < 0) {
+            // 没有读端：与 tee(1) 写入已关闭管道时一样丢弃
+            drop(m_buffer.size());
+            m_buffer.clear();
+            return;
+        }
+    } else {
+        if (!m_file.isOpen()) {
+            drop(m_buffer.size());
+            m_buffer.clear();
+            return;
+        }
+        if (m_rotateBytes > 0 && m_fileSize > 0 && m_fileSize + m_buffer.size() > m_rotateBytes) {
+            rotate();
+        }
+    }
+
+    qsizetype written = writeOut(m_buffer.constData(), m_buffer.size());
+    m_written += written;
+    m_fileSize += written;
+    TRACE_COUNT("TeeWriter::bytesWritten", written);
+    m_buffer.remove(0, written);
+
+    // FIFO 读端跟不上时保留积压，超过上限整体丢弃；普通文件写不进去说明出错（如磁盘已满）
+    if (!m_buffer.isEmpty() && (!m_fifo || m_buffer.size() > MaxBacklog)) {
+        drop(m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+qsizetype TeeWriter::writeOut(const char* data, qsizetype size) {
+    if (!m_fifo) {
+        qint64 written = m_file.write(data, size);
+        if (written < 0) {
+            m_error = m_file.errorString();
+            return 0;
+        }
+        return qsizetype(written);
+    }
+
+#ifdef Q_OS_UNIX
+    qsizetype total = 0;
+    while (total < size) {
+        ssize_t n = ::write(m_fd, data + total, size_t(size - total));
+        if (n > 0) {
+            total += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EPIPE) {
+            // 读端已关闭，之后重新打开等待新的读端
+            ::close(m_fd);
+            m_fd = -1;
+            m_reopenTimer.start();
+        }
+        break;   // EAGAIN：管道已满，剩余部分留到下一次
+    }
+    return total;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return 0;
+#endif
+}
+
+void TeeWriter::rotate() {
+    TRACE_SCOPE("TeeWriter::rotate");
+    m_file.close();
+
+    // path.(keep-1) -> path.keep ... path -> path.1，最旧的一份被覆盖
+    QFile::remove(QString("%1.%2").arg(m_path).arg(m_keep));
+    for (int i = m_keep - 1; i >= 1; --i) {
+        QString from = QString("%1.%2").arg(m_path).arg(i);
+        if (QFile::exists(from)) {
+            QFile::rename(from, QString("%1.%2").arg(m_path).arg(i + 1));
+        }
+    }
+    if (!QFile::rename(m_path, m_path + ".1")) {
+        qWarning() << "Failed to rotate tee target:" << m_path;
+    }
+    openFile();
+}
+
+void TeeWriter::drop(qint64 bytes) {
+    m_dropped += bytes;
+    TRACE_COUNT("TeeWriter::droppedBytes", bytes);
+}
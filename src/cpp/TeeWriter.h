@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+// 把命令的原始输出同时转发到文件、FIFO 或按大小轮转的日志（tee 模式）。
+// 在工作线程中使用，数据直接取自管道读取的原始字节，不经过解码和界面线程；
+// 小块读取先在内存中合并，每帧最多一次写入系统调用。
+// FIFO 以非阻塞方式写入，读端跟不上时积压到 MaxBacklog 后丢弃，读端关闭后自动重连，
+// 任何情况下都不会阻塞工作线程
+class TeeWriter {
+public:
+    static constexpr qsizetype BufferSize = 64 * 1024;          // 缓冲满时立即写出
+    static constexpr qint64 MaxBacklog = 8 * 1024 * 1024;       // FIFO 最多积压的字节数
+    static constexpr int DefaultKeep = 5;                        // 轮转时保留的旧文件数（.1 ~ .5）
+    static constexpr int ReopenInterval = 1000;                  // FIFO 没有读端时重试打开的间隔（毫秒）
+
+    // rotateBytes > 0 时普通文件超过该大小后轮转为 path.1、path.2 ...
+    TeeWriter(const QString& path, qint64 rotateBytes, int keep = DefaultKeep);
+    ~TeeWriter();
+    TeeWriter(const TeeWriter&) = delete;
+    TeeWriter& operator=(const TeeWriter&) = delete;
+
+    bool open();
+    void append(QByteArrayView data);
+    void flush();
+
+    QString path() const { return m_path; }
+    QString errorString() const { return m_error; }
+    qint64 bytesWritten() const { return m_written; }
+    qint64 droppedBytes() const { return m_dropped; }
+
+private:
+    bool openFile();
+    bool openFifo();
+    void closeTarget();
+    void rotate();
+    qsizetype writeOut(const char* data, qsizetype size);
+    void drop(qint64 bytes);
+
+    QString m_path;
+    qint64 m_rotateBytes;
+    int m_keep;
+    bool m_fifo = false;
+    QFile m_file;              // 普通文件
+    int m_fd = -1;             // FIFO（非阻塞）
+    qint64 m_fileSize = 0;
+    QByteArray m_buffer;
+    qint64 m_written = 0;
+    qint64 m_dropped = 0;
+    QElapsedTimer m_reopenTimer;
+    QString m_error;
+};
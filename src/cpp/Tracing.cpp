@@ -0,0 +1,195 @@
+#include "Tracing.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+
+namespace Tracing {
+
+namespace {
+thread_local Tracer* t_owner = nullptr;
+thread_local void* t_data = nullptr;
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() {
+    m_clock.start();
+    // 也可以通过环境变量在启动时打开，便于测量启动阶段
+    if (qEnvironmentVariableIntValue("RCMDLAUNCH_TRACE") > 0) {
+        m_enabled = true;
+        m_recording = true;
+    }
+}
+
+Tracer::ThreadData* Tracer::local() {
+    if (t_owner == this) {
+        return static_cast<ThreadData*>(t_data);
+    }
+
+    auto data = std::make_unique<ThreadData>();
+    QThread* thread = QThread::currentThread();
+    QCoreApplication* app = QCoreApplication::instance();
+    if (thread && !thread->objectName().isEmpty()) {
+        data->threadName = thread->objectName();
+    } else {
+        data->threadName = app && thread == app->thread() ? QString("main") : QString("thread");
+    }
+
+    QMutexLocker locker(&m_threadsMutex);
+    data->tid = int(m_threads.size()) + 1;
+    t_owner = this;
+    t_data = data.get();
+    m_threads.push_back(std::move(data));
+    return static_cast<ThreadData*>(t_data);
+}
+
+void Tracer::record(const char* name, qint64 startNs, qint64 durationNs) {
+    ThreadData* data = local();
+    // 只有读取快照或导出时才会与其他线程竞争这把锁
+    QMutexLocker locker(&data->mutex);
+    Stat& stat = data->stats[name];
+    ++stat.count;
+    stat.totalNs += durationNs;
+    stat.maxNs = qMax(stat.maxNs, durationNs);
+
+    if (isRecording()) {
+        if (data->events.size() < size_t(MaxEventsPerThread)) {
+            data->events.push_back({ name, startNs, durationNs });
+        } else {
+            data->events[data->nextEvent] = { name, startNs, durationNs };
+        }
+        data->nextEvent = (data->nextEvent + 1) % MaxEventsPerThread;
+    }
+}
+
+void Tracer::count(const char* name, qint64 value) {
+    ThreadData* data = local();
+    QMutexLocker locker(&data->mutex);
+    Stat& stat = data->stats[name];
+    ++stat.count;
+    stat.value += value;
+}
+
+QVariantList Tracer::snapshot() {
+    struct Row {
+        QString name;
+        QString thread;
+        Stat stat;
+    };
+    QList<Row> rows;
+
+    QMutexLocker locker(&m_threadsMutex);
+    for (const auto& data : m_threads) {
+        QMutexLocker dataLocker(&data->mutex);
+        for (auto it = data->stats.cbegin(); it != data->stats.cend(); ++it) {
+            // 同名字面量在不同编译单元中地址可能不同，按名称合并
+            QString name = QString::fromLatin1(it.key());
+            auto row = std::find_if(rows.begin(), rows.end(), [&](const Row& r) {
+                return r.name == name && r.thread == data->threadName;
+            });
+            if (row == rows.end()) {
+                rows.append({ name, data->threadName, it.value() });
+            } else {
+                row->stat.count += it->count;
+                row->stat.totalNs += it->totalNs;
+                row->stat.maxNs = qMax(row->stat.maxNs, it->maxNs);
+                row->stat.value += it->value;
+            }
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.stat.totalNs != b.stat.totalNs ? a.stat.totalNs > b.stat.totalNs : a.name < b.name;
+    });
+
+    QVariantList result;
+    for (const Row& row : std::as_const(rows)) {
+        QVariantMap item;
+        item["name"] = row.name;
+        item["thread"] = row.thread;
+        item["count"] = row.stat.count;
+        item["totalMs"] = row.stat.totalNs / 1e6;
+        item["avgUs"] = row.stat.count > 0 ? row.stat.totalNs / 1e3 / row.stat.count : 0.0;
+        item["maxUs"] = row.stat.maxNs / 1e3;
+        item["value"] = row.stat.value;
+        result.append(item);
+    }
+    return result;
+}
+
+void Tracer::reset() {
+    QMutexLocker locker(&m_threadsMutex);
+    for (const auto& data : m_threads) {
+        QMutexLocker dataLocker(&data->mutex);
+        data->stats.clear();
+        data->events.clear();
+        data->nextEvent = 0;
+    }
+}
+
+bool Tracer::exportChromeTrace(const QString& path) {
+    QJsonArray events;
+    {
+        QMutexLocker locker(&m_threadsMutex);
+        for (const auto& data : m_threads) {
+            QMutexLocker dataLocker(&data->mutex);
+            events.append(QJsonObject{
+                { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", data->tid },
+                { "args", QJsonObject{ { "name", data->threadName } } } });
+
+            for (const Event& event : data->events) {
+                events.append(QJsonObject{
+                    { "name", QString::fromLatin1(event.name) }, { "cat", "rcmdlaunch" }, { "ph", "X" },
+                    { "pid", 1 }, { "tid", data->tid },
+                    { "ts", event.startNs / 1e3 }, { "dur", event.durationNs / 1e3 } });
+            }
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write trace:" << path << file.errorString();
+        return false;
+    }
+    QJsonObject root{ { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+bool TraceController::available() const {
+#ifdef RCMDLAUNCH_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TraceController::setEnabled(bool enabled) {
+    if (Tracer::instance().isEnabled() == enabled) return;
+    Tracer::instance().setEnabled(enabled);
+    emit stateChanged();
+}
+
+void TraceController::setRecording(bool recording) {
+    if (Tracer::instance().isRecording() == recording) return;
+    Tracer::instance().setRecording(recording);
+    emit stateChanged();
+}
+
+QString TraceController::exportTrace() {
+    QString path = QString("%1/trace-%2.json")
+                       .arg(QCoreApplication::applicationDirPath(),
+                            QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    return Tracer::instance().exportChromeTrace(path) ? path : QString();
+}
+
+}
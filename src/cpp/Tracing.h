@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QVariant>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// 热路径的轻量计时与计数。
+//
+// TRACE_SCOPE("名称") 统计所在作用域的次数、总耗时和最大耗时；TRACE_COUNT("名称", n)
+// 只累加数值（例如读取的字节数）。名称必须是字符串字面量。
+// 编译时未定义 RCMDLAUNCH_TRACING 时两个宏展开为空；运行时关闭时只多一次原子读取。
+// 统计数据按线程分别记录，只有读取快照时才需要跨线程加锁。
+namespace Tracing {
+
+struct Stat {
+    qint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    qint64 value = 0;   // TRACE_COUNT 累加的数值
+};
+
+class Tracer {
+public:
+    static constexpr int MaxEventsPerThread = 200000;   // 录制时每个线程最多保留的事件数（环形覆盖）
+
+    static Tracer& instance();
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    // 录制逐条事件用于导出 Chrome trace，关闭时只保留汇总统计
+    bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+    void setRecording(bool recording) { m_recording.store(recording, std::memory_order_relaxed); }
+
+    qint64 nowNs() const { return m_clock.nsecsElapsed(); }
+    void record(const char* name, qint64 startNs, qint64 durationNs);
+    void count(const char* name, qint64 value);
+
+    // [{ name, thread, count, totalMs, avgUs, maxUs, value }]，按总耗时降序
+    QVariantList snapshot();
+    void reset();
+    // Chrome trace 事件格式，可在 chrome://tracing 或 Perfetto 中打开
+    bool exportChromeTrace(const QString& path);
+
+private:
+    struct Event {
+        const char* name;
+        qint64 startNs;
+        qint64 durationNs;
+    };
+
+    struct ThreadData {
+        QMutex mutex;
+        QString threadName;
+        int tid = 0;
+        QHash<const char*, Stat> stats;
+        std::vector<Event> events;
+        size_t nextEvent = 0;   // 环形缓冲中下一个写入位置
+    };
+
+    Tracer();
+    ThreadData* local();
+
+    std::atomic<bool> m_enabled{ false };
+    std::atomic<bool> m_recording{ false };
+    QElapsedTimer m_clock;
+    QMutex m_threadsMutex;
+    std::vector<std::unique_ptr<ThreadData>> m_threads;   // 线程结束后仍保留，便于导出
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : m_name(Tracer::instance().isEnabled() ? name : nullptr) {
+        if (m_name) m_start = Tracer::instance().nowNs();
+    }
+    ~TraceScope() {
+        if (m_name) {
+            Tracer& tracer = Tracer::instance();
+            tracer.record(m_name, m_start, tracer.nowNs() - m_start);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_start = 0;
+};
+
+// 暴露给 QML 诊断面板
+class TraceController : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool available READ available CONSTANT)
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY stateChanged)
+    Q_PROPERTY(bool recording READ recording WRITE setRecording NOTIFY stateChanged)
+
+public:
+    explicit TraceController(QObject* parent = nullptr) : QObject(parent) {}
+
+    bool available() const;   // 编译时是否启用了插桩
+    bool enabled() const { return Tracer::instance().isEnabled(); }
+    bool recording() const { return Tracer::instance().isRecording(); }
+    void setEnabled(bool enabled);
+    void setRecording(bool recording);
+
+    Q_INVOKABLE QVariantList snapshot() { return Tracer::instance().snapshot(); }
+    Q_INVOKABLE void reset() { Tracer::instance().reset(); }
+    // 导出到程序目录下的 trace-<时间>.json，返回文件路径，失败时返回空字符串
+    Q_INVOKABLE QString exportTrace();
+
+signals:
+    void stateChanged();
+};
+
+}
+
+#ifdef RCMDLAUNCH_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Tracing::TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_COUNT(name, value) \
+    do { \
+        if (Tracing::Tracer::instance().isEnabled()) Tracing::Tracer::instance().count(name, value); \
+    } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNT(name, value) do {} while (0)
+#endif
@@ -99,6 +99,14 @@ bool TrayManager::isTrayAvailable() const
     return QSystemTrayIcon::isSystemTrayAvailable();
 }
 
+void TrayManager::showNotification(const QString &title, const QString &message)
+{
+    // 托盘图标不可见时系统不会显示气泡
+    if (m_trayIcon && m_trayIcon->isVisible()) {
+        m_trayIcon->showMessage(title, message, QSystemTrayIcon::Warning);
+    }
+}
+
 void TrayManager::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
 {
     switch (reason) {
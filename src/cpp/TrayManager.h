@@ -17,6 +17,7 @@ public:
     Q_INVOKABLE void showTrayIcon();
     Q_INVOKABLE void hideTrayIcon();
     Q_INVOKABLE bool isTrayAvailable() const;
+    Q_INVOKABLE void showNotification(const QString &title, const QString &message);
 
 signals:
     void showMainWindow();
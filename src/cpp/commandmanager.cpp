@@ -2,243 +2,686 @@
 #include <QDebug>
 #include <QVariant>
 #include <QTimer>
-#include <QSqlDatabase>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QStandardPaths>
 #include <QDir>
 #include <QCoreApplication>
+#include <QGuiApplication>
+#include <QClipboard>
+#include <QQmlEngine>
+#include <QThread>
+#include <QDateTime>
 
-CommandManager::CommandManager(QObject* parent) : QObject(parent) {
-    initializeDatabase();
-    loadSavedCommands();
+CommandManager::CommandManager(QObject* parent)
+    : CommandManager(QCoreApplication::applicationDirPath(), parent) {}
+
+CommandManager::CommandManager(const QString& dataPath, QObject* parent) : QObject(parent) {
+    m_commandModel = new CommandListModel(this);
+    m_commandFilter = new CommandFilterModel(m_commandModel, this);
+    m_supervisor = new RestartSupervisor(this, this);
+
+    // 进程监管、管道读取和解码都在工作线程中进行，结果通过排队信号回到界面线程
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("ProcessWorker");
+    m_worker = new ProcessWorker();
+    m_worker->moveToThread(m_workerThread);
+    connect(m_worker, &ProcessWorker::processStarted, this, &CommandManager::handleProcessStarted);
+    connect(m_worker, &ProcessWorker::outputReady, this, &CommandManager::handleProcessOutput);
+    connect(m_worker, &ProcessWorker::processFailed, this, &CommandManager::handleProcessFailed);
+    connect(m_worker, &ProcessWorker::processError, this, &CommandManager::handleProcessError);
+    connect(m_worker, &ProcessWorker::processFinished, this, &CommandManager::handleProcessFinished);
+    connect(m_worker, &ProcessWorker::metricsSampled, this, &CommandManager::handleMetrics);
+    connect(m_worker, &ProcessWorker::patternsMatched, this, &CommandManager::handlePatternsMatched);
+    connect(m_worker, &ProcessWorker::processStopped, this, &CommandManager::handleProcessStopped);
+    connect(m_worker, &ProcessWorker::teeStats, this, &CommandManager::handleTeeStats);
+    m_workerThread->start();
+
+    m_archiveThread = new QThread(this);
+    m_archiveThread->setObjectName("RunArchiveWorker");
+    m_archiveWorker = new RunArchiveWorker();
+    m_archiveWorker->moveToThread(m_archiveThread);
+    m_archiveThread->start();
+
+    m_searchThread = new QThread(this);
+    m_searchThread->setObjectName("SearchWorker");
+    m_searchWorker = new SearchWorker();
+    m_searchWorker->moveToThread(m_searchThread);
+    m_searchThread->start();
+
+    initializeDatabase(dataPath);
+    loadSavedGroups();
+    loadSavedPatterns();
+
+    // 命令记录在事件循环中分页加载，窗口无需等待全部读取完成即可显示
+    QTimer::singleShot(0, this, &CommandManager::loadSavedCommands);
+}
+
+CommandManager::~CommandManager() {
+    QList<RunSummary> killed;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker]() {
+        return worker->shutdown();
+    }, Qt::BlockingQueuedConnection, &killed);
+    m_workerThread->quit();
+    m_workerThread->wait();
+    delete m_worker;
+
+    // 退出时被结束的运行也写入结束信息，否则下次启动后仍显示为运行中
+    for (const RunSummary& run : std::as_const(killed)) {
+        if (CommandEntry* entry = m_runs.value(run.runId)) {
+            finishRun(entry, -1, QProcess::CrashExit, run.peakRssKb, run.outputBytes);
+        }
+    }
+
+    m_archiveWorker->stop();
+    m_archiveThread->quit();
+    m_archiveThread->wait();
+    delete m_archiveWorker;
+
+    m_searchWorker->stop();
+    m_searchThread->quit();
+    m_searchThread->wait();
+    delete m_searchWorker;
+
+    // 关闭前提交所有排队的写入
+    QMetaObject::invokeMethod(m_store, &DatabaseWorker::close, Qt::BlockingQueuedConnection);
+    m_storeThread->quit();
+    m_storeThread->wait();
+    delete m_store;
 }
 
 QList<QObject*> CommandManager::commandList() {
-    return m_commandList;
+    QList<QObject*> list;
+    list.reserve(m_entries.size());
+    for (CommandEntry* entry : std::as_const(m_entries)) {
+        list.append(entry);
+    }
+    return list;
+}
+
+CommandEntry* CommandManager::entryFor(qint64 id) {
+    if (CommandEntry* entry = m_entries.value(id)) {
+        return entry;
+    }
+
+    // 第一次运行或查看输出时才创建 CommandEntry
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return nullptr;
+
+    CommandEntry* entry = createEntry(*record);
+    m_entries.insert(id, entry);
+    m_commandModel->attach(id, entry);
+    return entry;
+}
+
+qint64 CommandManager::commandId(const QString& name) const {
+    return m_commandModel->idOf(name);
+}
+
+void CommandManager::setOutputLimitBytes(qint64 bytes) {
+    if (m_outputLimitBytes == bytes) return;
+    m_outputLimitBytes = bytes;
+    for (CommandEntry* entry : std::as_const(m_entries)) {
+        entry->outputBuffer().setMaxBytes(bytes);
+        emit entry->outputChanged();
+    }
+    emit outputLimitsChanged();
 }
 
-void CommandManager::addCommand(const QString& name, const QString& command) {
-    if (m_commandMap.contains(name)) {
+void CommandManager::setOutputLimitLines(qint64 lines) {
+    if (m_outputLimitLines == lines) return;
+    m_outputLimitLines = lines;
+    for (CommandEntry* entry : std::as_const(m_entries)) {
+        entry->outputBuffer().setMaxLines(lines);
+        emit entry->outputChanged();
+    }
+    emit outputLimitsChanged();
+}
+
+void CommandManager::setOutputFlushInterval(int msec) {
+    msec = qMax(0, msec);
+    if (m_outputFlushInterval == msec) return;
+    m_outputFlushInterval = msec;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, msec, bytes = m_outputFlushThreshold]() {
+        worker->setFlushSettings(msec, bytes);
+    });
+    emit outputFlushSettingsChanged();
+}
+
+void CommandManager::setOutputFlushThreshold(int bytes) {
+    bytes = qMax(1, bytes);
+    if (m_outputFlushThreshold == bytes) return;
+    m_outputFlushThreshold = bytes;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, msec = m_outputFlushInterval, bytes]() {
+        worker->setFlushSettings(msec, bytes);
+    });
+    emit outputFlushSettingsChanged();
+}
+
+void CommandManager::setRunRetentionCount(int count) {
+    if (m_runRetentionCount == count) return;
+    m_runRetentionCount = count;
+    emit runRetentionChanged();
+}
+
+void CommandManager::setRunRetentionBytes(qint64 bytes) {
+    if (m_runRetentionBytes == bytes) return;
+    m_runRetentionBytes = bytes;
+    emit runRetentionChanged();
+}
+
+void CommandManager::setMetricsInterval(int msec) {
+    if (m_metricsInterval == msec) return;
+    m_metricsInterval = msec;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, msec]() {
+        worker->setMetricsInterval(msec);
+    });
+    emit metricsIntervalChanged();
+}
+
+CommandEntry* CommandManager::createEntry(const CommandRecord& record) {
+    auto* entry = new CommandEntry(record.id, record.name, record.command, this);
+    entry->launchMode = record.launchMode;
+    entry->argv = record.argv;
+    entry->restartPolicy = record.restartPolicy;
+    entry->setTeePath(record.teePath);
+    entry->teeRotateBytes = record.teeRotateBytes;
+    entry->setHighlightPatterns(m_patterns.value(record.name));
+    entry->outputBuffer().setMaxBytes(m_outputLimitBytes);
+    entry->outputBuffer().setMaxLines(m_outputLimitLines);
+    return entry;
+}
+
+qint64 CommandManager::addCommand(const QString& name, const QString& command) {
+    if (!isCommandNameUnique(name)) {
         qWarning() << "Command with name already exists:" << name;
-        return;
+        return 0;
     }
 
     qDebug() << "Adding command:" << name << command;
-    auto* entry = new CommandEntry(name, command, this);
-    m_commandMap.insert(name, entry);
-    m_commandList.append(entry);
     
-    // 保存到数据库
-    saveCommand(name, command);
+    // id 在界面线程中分配并随插入一起写入，新命令立即可以按 id 访问
+    CommandRecord record;
+    record.id = ++m_lastCommandId;
+    record.name = name;
+    record.command = command;
+    m_commandModel->append(record);
+    QMetaObject::invokeMethod(m_store, [store = m_store, id = record.id, name, command]() {
+        store->insertCommand(id, name, command);
+    });
     
-    qDebug() << "Command list size:" << m_commandList.size();
+    qDebug() << "Command list size:" << m_commandModel->rowCount();
     emit commandListChanged();
-    qDebug() << "Emitted commandListChanged signal";
+    return record.id;
+}
+
+void CommandManager::startCommand(qint64 id) {
+    TRACE_SCOPE("CommandManager::startCommand");
+    CommandEntry* entry = entryFor(id);
+    if (!entry) return;
+
+    // 手动启动会取消等待中的自动重启，并解除崩溃循环暂停
+    m_supervisor->reset(entry);
+    launchCommand(entry);
 }
 
 void CommandManager::startCommand(const QString& name) {
-    if (!m_commandMap.contains(name)) return;
+    startCommand(commandId(name));
+}
 
-    CommandEntry* entry = m_commandMap.value(name);
-    if (entry->process && entry->process->state() != QProcess::NotRunning) {
+void CommandManager::restartCommand(qint64 id) {
+    if (CommandEntry* entry = m_entries.value(id)) {
+        launchCommand(entry);
+    }
+}
+
+void CommandManager::launchCommand(CommandEntry* entry) {
+    TRACE_SCOPE("CommandManager::launchCommand");
+    const QString name = entry->name();
+    if (entry->isActive()) {
         qDebug() << "Command already running:" << name;
         return;
-    }    QProcess* process = new QProcess(this);
-    entry->process = process;
+    }
+
+    quint64 runId = m_nextRunId++;
+    m_runs.insert(runId, entry);
+    entry->runId = runId;
     entry->m_isStopping = false;  // 确保重置停止标志
+    entry->m_isStarting = true;   // 启动完成前由工作线程的 started/failed 通知更新状态
+    entry->resetPatternState();
+    entry->resetTeeStats();
+    emit entry->startingChanged();
 
-    QObject::connect(process, &QProcess::readyReadStandardOutput, [this, entry]() {
-        QByteArray out = entry->process->readAllStandardOutput();
+    // 直接启动时使用保存时缓存的 argv，省去 shell 的 fork/exec 和启动开销
+    QString program;
+    QStringList arguments;
+    entry->runDirect = entry->launchMode == LaunchMode::Direct && !entry->argv.isEmpty();
+    if (entry->runDirect) {
+        program = entry->argv.first();
+        arguments = entry->argv.mid(1);
+    } else {
+        if (entry->launchMode == LaunchMode::Direct) {
+            qWarning() << "Command needs a shell, launching through shell:" << name;
+        }
 #ifdef Q_OS_WIN
-        entry->appendOutput(QString::fromLocal8Bit(out));
+        program = "cmd.exe";
+        arguments = QStringList() << "/C" << entry->command();
 #else
-        entry->appendOutput(QString::fromUtf8(out));
+        program = "bash";
+        arguments = QStringList() << "-c" << entry->command();
 #endif
-        emit outputUpdated(entry->name());
+    }
+    entry->launchTimer.start();
+
+    // 每次运行都记录到 runs 表，输出由工作线程直接写入压缩归档
+    entry->runStartedAt = QDateTime::currentMSecsSinceEpoch();
+    entry->runArchive = QString("%1-%2.seg").arg(entry->runStartedAt).arg(runId);
+    writeDatabase("INSERT INTO runs (command_name, started_at, archive) VALUES (?, ?, ?)",
+                  { name, entry->runStartedAt, entry->runArchive });
+    QString archivePath = m_archiveDir + "/" + entry->runArchive;
+
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, runId, program, arguments, archivePath,
+                                         patterns = m_patterns.value(name), teePath = entry->teePath(),
+                                         teeRotateBytes = entry->teeRotateBytes]() {
+        worker->startProcess(runId, program, arguments, archivePath, patterns, teePath, teeRotateBytes);
     });
+}
 
-    QObject::connect(process, &QProcess::readyReadStandardError, [this, entry]() {
-        QByteArray out = entry->process->readAllStandardError();
-#ifdef Q_OS_WIN
-        entry->appendOutput(QString::fromLocal8Bit(out));
-#else
-        entry->appendOutput(QString::fromUtf8(out));
-#endif
-        emit outputUpdated(entry->name());
-    });    QObject::connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                     [this, entry](int exitCode, QProcess::ExitStatus exitStatus) {
-                         // 停止并清理定时器
-                         if (entry->stopTimer) {
-                             entry->stopTimer->stop();
-                         }
-                           entry->m_isStopping = false;  // 重置停止标志
-                         
-                         // 只有在非主动停止且异常退出时才显示警告
-                         if (exitStatus == QProcess::CrashExit && !entry->m_isStopping) {
-                             qWarning() << "Process crashed with exit code:" << exitCode;
-                         }
-                         
-                         emit commandStatusChanged(entry->name(), false);
-                         emit entry->runningChanged();
-                         emit entry->stoppingChanged();
-                     });    QObject::connect(process, &QProcess::errorOccurred, [this, entry](QProcess::ProcessError err) {
-        // 只有在非主动停止的情况下才输出错误
-        if (!entry->m_isStopping) {
-            qWarning() << "Process error:" << err;
+void CommandManager::handleProcessStarted(quint64 runId, qint64 pid) {
+    CommandEntry* entry = m_runs.value(runId);
+    if (!entry) return;
+
+    entry->pid = pid;
+    entry->m_isStarting = false;
+    entry->m_isRunning = true;
+
+    // 启动耗时：从 startCommand 到进程 exec 成功，包括与工作线程之间的排队
+    qint64 us = entry->launchTimer.nsecsElapsed() / 1000;
+    LaunchStats& stats = m_launchStats[entry->runDirect ? int(LaunchMode::Direct) : int(LaunchMode::Shell)];
+    stats.minUs = stats.count == 0 ? us : qMin(stats.minUs, us);
+    stats.maxUs = qMax(stats.maxUs, us);
+    stats.totalUs += us;
+    ++stats.count;
+    entry->reportLaunch(us);
+    emit launchStatsChanged();
+
+    emit commandStatusChanged(entry->name(), true);
+    emit entry->startingChanged();
+    emit entry->runningChanged();
+}
+
+void CommandManager::handleProcessOutput(quint64 runId, const QByteArray& data,
+                                         const QList<OutputSegment>& segments, int chunks) {
+    TRACE_SCOPE("CommandManager::handleProcessOutput");
+    CommandEntry* entry = m_runs.value(runId);
+    if (!entry) return;
+
+    entry->appendOutput(data, segments);
+    entry->recordFlush(chunks);
+
+    ++m_flushCount;
+    m_flushedChunks += chunks;
+    emit flushStatsChanged();
+    emit outputUpdated(entry->name());
+}
+
+void CommandManager::handleMetrics(const QList<ProcessMetrics>& metrics) {
+    for (const ProcessMetrics& m : metrics) {
+        if (CommandEntry* entry = m_runs.value(m.runId)) {
+            entry->updateMetrics(m);
         }
-        emit commandStatusChanged(entry->name(), false);
-        emit entry->runningChanged();
-    });
+    }
+}
 
-#ifdef Q_OS_WIN
-    process->start("cmd.exe", QStringList() << "/C" << entry->command());
-#else
-    process->start("bash", QStringList() << "-c" << entry->command());
-#endif
+void CommandManager::handlePatternsMatched(quint64 runId, const QList<PatternHit>& hits, int highlights) {
+    CommandEntry* entry = m_runs.value(runId);
+    if (!entry) return;
 
-    if (!process->waitForStarted()) {
-        qWarning() << "Failed to start process:" << entry->command();
-        delete process;
-        entry->process = nullptr;    } else {
-        emit commandStatusChanged(name, true);
-        emit entry->runningChanged();
+    if (highlights > 0) {
+        entry->addHighlights(highlights);
+    }
+    // 同一批输出中的多条通知只提醒第一条，避免刷屏
+    bool alerted = false;
+    for (const PatternHit& hit : hits) {
+        if (hit.action == PatternAction::Ready) {
+            if (entry->isReady()) continue;
+            entry->setReady(true);
+            qDebug() << "Command ready:" << entry->name();
+            emit commandReady(entry->name());
+        } else if (hit.action == PatternAction::Notify && !alerted) {
+            alerted = true;
+            entry->setLastAlert(hit.line);
+            emit commandAlert(entry->name(), hit.line);
+        }
     }
 }
 
-void CommandManager::stopCommand(const QString& name) {
-    if (!m_commandMap.contains(name)) return;
+void CommandManager::handleProcessFailed(quint64 runId, const QString& error) {
+    CommandEntry* entry = m_runs.take(runId);
+    if (!entry) return;
+
+    qWarning() << "Failed to start process:" << entry->command() << error;
+    finishRun(entry, -1, QProcess::CrashExit, 0, 0);
+    entry->runId = 0;
+    entry->pid = 0;
+    entry->m_isStarting = false;
+    entry->m_isRunning = false;
+    emit entry->startingChanged();
+    emit commandStatusChanged(entry->name(), false);
+    emit entry->runningChanged();
+
+    // 启动失败按崩溃处理，连续失败会被崩溃循环检测暂停
+    m_supervisor->processExited(entry, -1, QProcess::CrashExit, false);
+}
+
+void CommandManager::handleProcessError(quint64 runId, int error) {
+    CommandEntry* entry = m_runs.value(runId);
+    if (!entry) return;
+
+    // 只有在非主动停止的情况下才输出错误
+    if (!entry->m_isStopping) {
+        qWarning() << "Process error:" << entry->name() << QProcess::ProcessError(error);
+    }
+}
+
+void CommandManager::handleProcessFinished(quint64 runId, int exitCode, int exitStatus,
+                                           qint64 peakRssKb, qint64 outputBytes) {
+    CommandEntry* entry = m_runs.take(runId);
+    if (!entry) return;
+
+    finishRun(entry, exitCode, exitStatus, peakRssKb, outputBytes);
+    entry->resetMetrics();
+
+    bool userStopped = entry->m_isStopping || m_stoppingRuns.contains(runId);
+
+    // 只有在非主动停止且异常退出时才显示警告
+    if (exitStatus == QProcess::CrashExit && !entry->m_isStopping) {
+        qWarning() << "Process crashed with exit code:" << exitCode;
+    }
+
+    entry->runId = 0;
+    entry->pid = 0;
+    entry->m_isRunning = false;
+    entry->m_isStarting = false;
+    // 主动停止时要等到整个进程树退出（processStopped）才结束停止状态
+    if (!m_stoppingRuns.contains(runId)) {
+        entry->m_isStopping = false;
+    }
+
+    emit commandFinished(entry->name(), exitCode, exitStatus);
+    emit commandStatusChanged(entry->name(), false);
+    emit entry->runningChanged();
+    emit entry->stoppingChanged();
+
+    m_supervisor->processExited(entry, exitCode, exitStatus, userStopped);
+}
+
+void CommandManager::handleProcessStopped(quint64 runId, qint64 elapsedMs, bool escalated, int survivors) {
+    CommandEntry* entry = m_stoppingRuns.take(runId);
+    if (!entry) return;
+
+    qDebug() << "Command stopped:" << entry->name() << elapsedMs << "ms"
+             << (escalated ? "(killed)" : "") << survivors << "survivors";
+    entry->reportStop(elapsedMs, escalated);
+    // 进程树退出时通常已收到 finished；若等待超时进程仍在，保留运行状态
+    if (!entry->isActive()) {
+        entry->m_isStopping = false;
+        emit entry->stoppingChanged();
+    }
+    emit commandStopped(entry->name(), elapsedMs, escalated, survivors);
+}
+
+void CommandManager::handleTeeStats(quint64 runId, qint64 bytes, double mbPerSec, qint64 dropped,
+                                    const QString& error) {
+    CommandEntry* entry = m_runs.value(runId);
+    if (!entry) return;
+    if (!error.isEmpty() && error != entry->teeError()) {
+        qWarning() << "Tee target error:" << entry->name() << entry->teePath() << error;
+    }
+    entry->updateTeeStats(bytes, mbPerSec, dropped, error);
+}
+
+void CommandManager::finishRun(CommandEntry* entry, int exitCode, int exitStatus,
+                               qint64 peakRssKb, qint64 outputBytes) {
+    qint64 finishedAt = QDateTime::currentMSecsSinceEpoch();
+    writeDatabase("UPDATE runs SET finished_at = ?, duration_ms = ?, exit_code = ?, exit_status = ?, "
+                  "peak_rss_kb = ?, output_bytes = ? WHERE archive = ?",
+                  { finishedAt, finishedAt - entry->runStartedAt, exitCode, exitStatus,
+                    peakRssKb, outputBytes, entry->runArchive });
+    entry->runArchive.clear();
+    entry->hasExited = true;
+    entry->lastExitCode = exitCode;
+    entry->lastExitStatus = exitStatus;
 
-    CommandEntry* entry = m_commandMap.value(name);
-    if (entry->process && entry->process->state() != QProcess::NotRunning) {
+    // 运行记录在数据库线程中按保留上限清理，排在上面的更新之后执行
+    if (m_runRetentionCount > 0 || m_runRetentionBytes > 0) {
+        QMetaObject::invokeMethod(m_store, [store = m_store, name = entry->name(), keepRuns = m_runRetentionCount,
+                                            keepBytes = m_runRetentionBytes, dir = m_archiveDir]() {
+            store->pruneRuns(name, keepRuns, keepBytes, dir);
+        });
+    }
+}
+
+void CommandManager::releaseEntry(CommandEntry* entry) {
+    // 命令被删除时直接结束其进程并丢弃本次运行的归档（由进程线程在写完后删除），
+    // 之后的工作线程通知会因找不到运行而被忽略，不会再更新已删除的运行记录
+    m_supervisor->cancel(entry);
+    if (entry->isActive()) {
+        QString archivePath = entry->runArchive.isEmpty() ? QString() : m_archiveDir + "/" + entry->runArchive;
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker, runId = entry->runId, archivePath]() {
+            worker->discardRun(runId, archivePath);
+        });
+        m_runs.remove(entry->runId);
+        m_stoppingRuns.remove(entry->runId);
+    }
+    entry->deleteLater();
+}
+
+void CommandManager::stopCommand(qint64 id) {
+    CommandEntry* entry = m_entries.value(id);
+    if (!entry) return;
+
+    // 停止也会取消等待中的自动重启
+    m_supervisor->cancel(entry);
+    if (entry->isActive() && !m_stoppingRuns.contains(entry->runId)) {
         entry->m_isStopping = true;  // 标记为主动停止
         emit entry->stoppingChanged();  // 发射信号通知UI更新
         
-        // 创建定时器用于超时控制
-        if (!entry->stopTimer) {
-            entry->stopTimer = new QTimer(this);
-            entry->stopTimer->setSingleShot(true);
-        }
-        
-        // 连接进程结束信号，确保在进程正常结束时清理
-        QObject::connect(entry->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                         entry->stopTimer, &QTimer::stop, Qt::UniqueConnection);
-        
-        // 设置3秒超时，如果进程还没结束则强制杀死
-        QObject::connect(entry->stopTimer, &QTimer::timeout, [this, entry]() {
-            forceKillProcess(entry);
+        // 工作线程向整个进程树发送 SIGTERM，超时后升级为 SIGKILL，全部退出后通过 processStopped 报告耗时
+        m_stoppingRuns.insert(entry->runId, entry);
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker, runId = entry->runId]() {
+            worker->stopProcess(runId, StopTimeout);
         });
         
-        // 先尝试温和的终止
-        entry->process->terminate();
-        entry->stopTimer->start(3000);  // 3秒超时
-        
-        // 立即更新UI状态，不等待进程实际结束
-        entry->clearOutput();
-        emit commandStatusChanged(name, false);
+        // 立即更新UI状态，不等待进程实际结束；输出保留到下次清空，便于查看停止前的日志
+        emit commandStatusChanged(entry->name(), false);
         emit entry->runningChanged();
     }
 }
 
+void CommandManager::stopCommand(const QString& name) {
+    stopCommand(commandId(name));
+}
+
 QString CommandManager::getOutput(const QString& name) {
-    if (!m_commandMap.contains(name)) return "";
-    return m_commandMap[name]->output();
+    CommandEntry* entry = m_entries.value(commandId(name));
+    return entry ? entry->output() : QString();
 }
 
-bool CommandManager::isRunning(const QString& name) {
-    if (!m_commandMap.contains(name)) return false;
-    auto* p = m_commandMap[name]->process;
-    return p && p->state() != QProcess::NotRunning;
+QVariantMap CommandManager::readOutput(const QString& name, qint64 fromOffset, bool raw) {
+    QVariantMap result;
+    CommandEntry* entry = m_entries.value(commandId(name));
+    if (!entry) return result;
+
+    // 请求的位置已被淘汰或清空时，要求调用方用完整内容重置显示
+    bool reset = fromOffset < entry->outputStart() || fromOffset > entry->outputEnd();
+    qint64 offset = reset ? entry->outputStart() : fromOffset;
+    // 末尾被读取边界切开的字符或转义序列留到下一次，调用方以 end 作为下次的起点
+    qint64 end = qMax(offset, entry->outputCompleteEnd());
+
+    result["reset"] = reset;
+    result["offset"] = offset;
+    result["end"] = end;
+    result["text"] = entry->outputBetween(offset, end, raw);
+    return result;
 }
 
-void CommandManager::clearOutput(const QString& name) {
-    if (!m_commandMap.contains(name)) return;
-    m_commandMap[name]->clearOutput();
-    emit outputUpdated(name);
+QObject* CommandManager::outputModel(qint64 id) {
+    CommandEntry* entry = entryFor(id);
+    if (!entry) return nullptr;
+
+    if (!entry->logModel) {
+        entry->logModel = new LogModel(entry, entry);
+        QQmlEngine::setObjectOwnership(entry->logModel, QQmlEngine::CppOwnership);
+    }
+    return entry->logModel;
 }
 
-void CommandManager::forceKillProcess(CommandEntry* entry) {
-    if (entry->process && entry->process->state() != QProcess::NotRunning) {
-        qDebug() << "Force killing process for command:" << entry->name();
-        entry->process->kill();
-        
-        // 创建一个单次定时器，在1秒后完成清理工作
-        QTimer* killTimer = new QTimer(this);
-        killTimer->setSingleShot(true);
-        QObject::connect(killTimer, &QTimer::timeout, [this, entry, killTimer]() {
-            entry->m_isStopping = false;  // 重置标记
-            emit entry->stoppingChanged();  // 发射信号通知UI更新
-            killTimer->deleteLater();
-        });
-        killTimer->start(1000);
-    } else {
-        entry->m_isStopping = false;  // 重置标记
-        emit entry->stoppingChanged();  // 发射信号通知UI更新
+QObject* CommandManager::stderrModel(qint64 id) {
+    CommandEntry* entry = entryFor(id);
+    if (!entry) return nullptr;
+
+    if (!entry->stderrModel) {
+        auto* source = static_cast<LogModel*>(outputModel(id));
+        entry->stderrModel = new LogFilterModel(source, int(OutputStream::Stderr), entry);
+        QQmlEngine::setObjectOwnership(entry->stderrModel, QQmlEngine::CppOwnership);
     }
+    return entry->stderrModel;
 }
 
-void CommandManager::removeCommand(const QString& name) {
-    if (!m_commandMap.contains(name)) return;
-    
-    CommandEntry* entry = m_commandMap.value(name);
-    
-    // 先停止命令（如果正在运行）
-    if (entry->process && entry->process->state() != QProcess::NotRunning) {
-        stopCommand(name);
+QObject* CommandManager::outputSearch(qint64 id) {
+    CommandEntry* entry = entryFor(id);
+    if (!entry) return nullptr;
+
+    if (!entry->search) {
+        entry->search = new OutputSearch(entry, m_searchWorker, entry);
+        QQmlEngine::setObjectOwnership(entry->search, QQmlEngine::CppOwnership);
     }
-    
-    // 从数据库删除
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM commands WHERE name = ?");
-    query.addBindValue(name);
-    if (!query.exec()) {
-        qWarning() << "Failed to delete command from database:" << query.lastError().text();
+    return entry->search;
+}
+
+void CommandManager::copyOutput(qint64 id) {
+    if (CommandEntry* entry = m_entries.value(id)) {
+        QGuiApplication::clipboard()->setText(entry->output());
     }
-    
-    // 从内存中删除
-    m_commandMap.remove(name);
-    m_commandList.removeOne(entry);
-    entry->deleteLater();
-    
-    emit commandListChanged();
 }
 
-void CommandManager::saveCommand(const QString& name, const QString& command) {
-    QSqlQuery query(m_database);
+bool CommandManager::isRunning(qint64 id) {
+    CommandEntry* entry = m_entries.value(id);
+    return entry && entry->isActive();
+}
+
+bool CommandManager::isRunning(const QString& name) {
+    return isRunning(commandId(name));
+}
+
+QVariantMap CommandManager::commandStatus(const QString& name) const {
+    QVariantMap status;
+    const CommandRecord* record = m_commandModel->record(name);
+    if (!record) return status;
+
+    CommandEntry* entry = m_entries.value(record->id);
+    QString state = "stopped";
+    if (entry && entry->isActive()) {
+        state = entry->isStopping() ? "stopping" : (entry->isStarting() ? "starting" : "running");
+    }
+    status["state"] = state;
+    status["pid"] = entry ? entry->pid : 0;
+    status["ready"] = entry && entry->isReady();
+    status["restartCount"] = entry ? entry->restartCount() : 0;
+    status["lastExitReason"] = entry ? entry->lastExitReason() : QString();
+    if (entry && entry->hasExited) {
+        status["exitCode"] = entry->lastExitCode;
+        status["exitStatus"] = entry->lastExitStatus;
+    }
+    if (!record->teePath.isEmpty()) {
+        status["tee"] = teeTarget(record->id);
+    }
+    return status;
+}
+
+void CommandManager::clearOutput(qint64 id) {
+    CommandEntry* entry = m_entries.value(id);
+    if (!entry) return;
+    entry->clearOutput();
+    emit outputUpdated(entry->name());
+}
+
+void CommandManager::removeCommand(qint64 id) {
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return;
     
-    // 使用 INSERT OR REPLACE 来处理更新和插入
-    query.prepare("INSERT OR REPLACE INTO commands (name, command, created_at) VALUES (?, ?, datetime('now'))");
-    query.addBindValue(name);
-    query.addBindValue(command);
+    const QString name = record->name;
+    CommandEntry* entry = m_entries.value(id);
     
-    if (!query.exec()) {
-        qWarning() << "Failed to save command:" << query.lastError().text();
-        return;
+    // 从数据库删除，连同运行历史和归档文件：在数据库线程中一次完成查询、删除记录和删除文件。
+    // 正在运行时本次的归档还在写入，交给 releaseEntry 在进程结束后删除
+    QString activeArchive = entry && entry->isActive() ? entry->runArchive : QString();
+    QMetaObject::invokeMethod(m_store, [store = m_store, name, dir = m_archiveDir, activeArchive]() {
+        store->deleteRuns(name, dir, activeArchive);
+    });
+    writeDatabase("DELETE FROM command_patterns WHERE command_name = ?", { name });
+    writeDatabase("DELETE FROM commands WHERE id = ?", { id });
+    m_patterns.remove(name);
+    removeGroupMembers(name);
+    
+    // 从内存中删除
+    m_entries.remove(id);
+    m_commandModel->remove(id);
+    if (entry) {
+        releaseEntry(entry);
     }
     
-    qDebug() << "Command saved:" << name;
+    emit commandListChanged();
+}
+
+void CommandManager::writeDatabase(const QString& sql, const QVariantList& values) {
+    QMetaObject::invokeMethod(m_store, [store = m_store, sql, values]() {
+        store->execute(sql, values);
+    });
 }
 
 void CommandManager::loadSavedCommands() {
-    QSqlQuery query("SELECT name, command FROM commands ORDER BY created_at", m_database);
-    
-    while (query.next()) {
-        QString name = query.value(0).toString();
-        QString command = query.value(1).toString();
+    if (m_commandsLoaded) return;
+
+    // 每次只读取一页，由数据库线程读取后通过 handleCommandPage 回到界面线程
+    QMetaObject::invokeMethod(m_store, [store = m_store, afterId = m_lastLoadedId]() {
+        store->loadCommandPage(afterId, CommandPageSize);
+    });
+}
+
+void CommandManager::handleCommandPage(const QList<StoredCommand>& commands, bool finished) {
+    TRACE_SCOPE("CommandManager::handleCommandPage");
+    QList<CommandRecord> page;
+    for (const StoredCommand& stored : commands) {
+        m_lastLoadedId = stored.id;
+        
+        // 加载过程中新添加的命令已经在列表中
+        if (m_commandModel->contains(stored.id)) continue;
         
-        if (!createCommandFromDatabase(name, command)) {
-            qWarning() << "Failed to create command from database:" << name;
+        CommandRecord record;
+        record.id = stored.id;
+        record.name = stored.name;
+        record.command = stored.command;
+        if (stored.launchMode == int(LaunchMode::Direct)) {
+            record.launchMode = LaunchMode::Direct;
+            record.argv = CommandLine::directArgv(record.command);
         }
+        record.restartPolicy = RestartPolicy(qBound(0, stored.restartPolicy, 2));
+        record.teePath = stored.teePath;
+        record.teeRotateBytes = qMax<qint64>(0, stored.teeRotateBytes);
+        page.append(record);
     }
+    m_commandModel->appendRecords(page);
     
-    if (query.lastError().isValid()) {
-        qWarning() << "Failed to load commands:" << query.lastError().text();
+    if (finished) {
+        m_commandsLoaded = true;
+        qDebug() << "Loaded" << m_commandModel->rowCount() << "commands from database";
+        emit commandsLoadedChanged();
+    } else {
+        loadSavedCommands();
     }
 }
 
-bool CommandManager::initializeDatabase() {
-    // 获取应用安装目录
-    QString dataPath = QCoreApplication::applicationDirPath();
+bool CommandManager::initializeDatabase(const QString& dataPath) {
     QDir dataDir;
     if (!dataDir.mkpath(dataPath)) {
         qWarning() << "Failed to create data directory:" << dataPath;
@@ -246,142 +689,475 @@ bool CommandManager::initializeDatabase() {
     }
     
     QString dbPath = dataPath + "/commands.db";
+    m_archiveDir = dataPath + "/runs";
+    if (!dataDir.mkpath(m_archiveDir)) {
+        qWarning() << "Failed to create run archive directory:" << m_archiveDir;
+    }
     
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
-    m_database.setDatabaseName(dbPath);
+    // 所有数据库访问都在独立线程中进行，写入按事务批量提交
+    m_storeThread = new QThread(this);
+    m_storeThread->setObjectName("DatabaseWorker");
+    m_store = new DatabaseWorker();
+    m_store->moveToThread(m_storeThread);
+    connect(m_store, &DatabaseWorker::commandPageLoaded, this, &CommandManager::handleCommandPage);
+    connect(m_store, &DatabaseWorker::writeFailed, this, [](const QString& error) {
+        qWarning() << "Failed to write database:" << error;
+    });
+    m_storeThread->start();
     
-    if (!m_database.open()) {
-        qWarning() << "Failed to open database:" << m_database.lastError().text();
+    bool opened = false;
+    QMetaObject::invokeMethod(m_store, [store = m_store, dbPath]() {
+        return store->open(dbPath);
+    }, Qt::BlockingQueuedConnection, &opened);
+    if (opened) {
+        QMetaObject::invokeMethod(m_store, [store = m_store]() {
+            return store->lastCommandId();
+        }, Qt::BlockingQueuedConnection, &m_lastCommandId);
+    }
+    return opened;
+}
+
+bool CommandManager::editCommand(qint64 id, const QString& newName, const QString& newCommand) {
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) {
+        qWarning() << "Command not found:" << id;
         return false;
     }
     
-    // 创建表
-    QSqlQuery query(m_database);
-    QString createTableSQL = R"(
-        CREATE TABLE IF NOT EXISTS commands (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            name TEXT UNIQUE NOT NULL,
-            command TEXT NOT NULL,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createTableSQL)) {
-        qWarning() << "Failed to create table:" << query.lastError().text();
+    const QString oldName = record->name;
+    const bool renamed = oldName != newName;
+    const bool changed = record->command != newCommand;
+    if (!renamed && !changed) return true;
+
+    // 如果名称改变了，检查新名称是否唯一
+    if (renamed && !isCommandNameUnique(newName, id)) {
+        qWarning() << "Command name already exists:" << newName;
         return false;
     }
     
-    qDebug() << "Database initialized successfully at:" << dbPath;
+    // 更新数据库：写入在数据库线程中排队提交，失败时由 writeFailed 记录。
+    // 运行历史、输出模式和命令组成员仍按名称关联，改名时一起更新
+    writeDatabase("UPDATE commands SET name = ?, command = ?, updated_at = datetime('now') WHERE id = ?",
+                  { newName, newCommand, id });
+    if (renamed) {
+        writeDatabase("UPDATE runs SET command_name = ? WHERE command_name = ?", { newName, oldName });
+        writeDatabase("UPDATE command_patterns SET command_name = ? WHERE command_name = ?", { newName, oldName });
+        if (m_patterns.contains(oldName)) {
+            m_patterns.insert(newName, m_patterns.take(oldName));
+        }
+        renameGroupMembers(oldName, newName);
+    }
+    
+    // 原地修改列表行和已创建的 CommandEntry，只通知变化的属性；
+    // 正在运行的进程和已有输出保留，新命令在下次启动时生效
+    LaunchMode launchMode = record->launchMode;
+    m_commandModel->update(id, newName, newCommand);
+    if (changed && launchMode == LaunchMode::Direct) {
+        m_commandModel->setLaunch(id, LaunchMode::Direct, CommandLine::directArgv(newCommand));
+    }
+    if (CommandEntry* entry = m_entries.value(id)) {
+        entry->setName(newName);
+        entry->setCommand(newCommand);
+        if (changed && launchMode == LaunchMode::Direct) {
+            entry->argv = m_commandModel->record(id)->argv;
+        }
+    }
+    
+    qDebug() << "Command edited successfully:" << oldName << "->" << newName;
     return true;
 }
 
-bool CommandManager::createCommandFromDatabase(const QString& name, const QString& command) {
-    if (m_commandMap.contains(name)) {
-        qWarning() << "Command with name already exists:" << name;
-        return false;
+bool CommandManager::isCommandNameUnique(const QString& name, qint64 excludeId) {
+    TRACE_SCOPE("CommandManager::isCommandNameUnique");
+    // 检查内存中的命令：名称索引是哈希表，不随命令数量变慢
+    if (const CommandRecord* record = m_commandModel->record(name)) {
+        return record->id == excludeId;
     }
+    // 尚未加载完时，还需要检查数据库中未读取的记录
+    if (!m_commandsLoaded) {
+        bool exists = false;
+        QMetaObject::invokeMethod(m_store, [store = m_store, name]() {
+            return store->commandExists(name);
+        }, Qt::BlockingQueuedConnection, &exists);
+        if (exists) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString CommandManager::getCommandContent(qint64 id) {
+    const CommandRecord* record = m_commandModel->record(id);
+    return record ? record->command : QString();
+}
+
+QString CommandManager::getCommandContent(const QString& name) {
+    const CommandRecord* record = m_commandModel->record(name);
+    return record ? record->command : QString();
+}
+
+int CommandManager::launchMode(qint64 id) {
+    const CommandRecord* record = m_commandModel->record(id);
+    return record ? int(record->launchMode) : int(LaunchMode::Shell);
+}
 
-    qDebug() << "Loading command from database:" << name << command;
-    auto* entry = new CommandEntry(name, command, this);
-    m_commandMap.insert(name, entry);
-    m_commandList.append(entry);
+bool CommandManager::setLaunchMode(qint64 id, int mode) {
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return false;
+
+    LaunchMode launchMode = mode == int(LaunchMode::Direct) ? LaunchMode::Direct : LaunchMode::Shell;
+    QStringList argv;
+    if (launchMode == LaunchMode::Direct) {
+        // 保存时分词一次，之后每次启动直接使用
+        argv = CommandLine::directArgv(record->command);
+        if (argv.isEmpty()) {
+            qWarning() << "Command uses shell syntax and cannot be launched directly:" << record->name;
+            return false;
+        }
+    }
+
+    writeDatabase("UPDATE commands SET launch_mode = ? WHERE id = ?", { int(launchMode), id });
+    m_commandModel->setLaunch(id, launchMode, argv);
+    if (CommandEntry* entry = m_entries.value(id)) {
+        entry->launchMode = launchMode;
+        entry->argv = argv;
+    }
     return true;
 }
 
-bool CommandManager::editCommand(const QString& oldName, const QString& newName, const QString& newCommand) {
-    if (!m_commandMap.contains(oldName)) {
-        qWarning() << "Command not found:" << oldName;
+int CommandManager::restartPolicy(qint64 id) {
+    const CommandRecord* record = m_commandModel->record(id);
+    return record ? int(record->restartPolicy) : int(RestartPolicy::Never);
+}
+
+bool CommandManager::setRestartPolicy(qint64 id, int policy) {
+    if (!m_commandModel->contains(id) || policy < 0 || policy > int(RestartPolicy::Always)) return false;
+
+    writeDatabase("UPDATE commands SET restart_policy = ? WHERE id = ?", { policy, id });
+    m_commandModel->setRestartPolicy(id, RestartPolicy(policy));
+    if (CommandEntry* entry = m_entries.value(id)) {
+        entry->restartPolicy = RestartPolicy(policy);
+        if (entry->restartPolicy == RestartPolicy::Never) {
+            m_supervisor->cancel(entry);
+        }
+    }
+    return true;
+}
+
+QVariantMap CommandManager::teeTarget(qint64 id) const {
+    QVariantMap result;
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return result;
+
+    CommandEntry* entry = m_entries.value(id);
+    result["path"] = record->teePath;
+    result["rotateBytes"] = record->teeRotateBytes;
+    result["bytes"] = entry ? entry->teeBytes() : 0;
+    result["rate"] = entry ? entry->teeRate() : 0.0;
+    result["dropped"] = entry ? entry->teeDropped() : 0;
+    result["error"] = entry ? entry->teeError() : QString();
+    return result;
+}
+
+bool CommandManager::setTeeTarget(qint64 id, const QString& path, qint64 rotateBytes) {
+    if (!m_commandModel->contains(id) || rotateBytes < 0) return false;
+
+    QString target = path.trimmed();
+    writeDatabase("UPDATE commands SET tee_path = ?, tee_rotate_bytes = ? WHERE id = ?", { target, rotateBytes, id });
+    m_commandModel->setTee(id, target, rotateBytes);
+    if (CommandEntry* entry = m_entries.value(id)) {
+        entry->setTeePath(target);
+        entry->teeRotateBytes = rotateBytes;
+    }
+    return true;
+}
+
+bool CommandManager::canLaunchDirect(const QString& command) const {
+    return !CommandLine::directArgv(command).isEmpty();
+}
+
+QVariantMap CommandManager::launchStats() const {
+    QVariantMap result;
+    const char* keys[] = { "shell", "direct" };
+    for (int mode = 0; mode < 2; ++mode) {
+        const LaunchStats& stats = m_launchStats[mode];
+        QVariantMap item;
+        item["count"] = stats.count;
+        item["avgUs"] = stats.count > 0 ? stats.totalUs / stats.count : 0;
+        item["minUs"] = stats.minUs;
+        item["maxUs"] = stats.maxUs;
+        result[keys[mode]] = item;
+    }
+    return result;
+}
+
+QVariantList CommandManager::outputPatterns(qint64 id) const {
+    QVariantList result;
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return result;
+
+    for (const OutputPattern& p : m_patterns.value(record->name)) {
+        QVariantMap item;
+        item["pattern"] = p.pattern;
+        item["action"] = int(p.action);
+        result.append(item);
+    }
+    return result;
+}
+
+bool CommandManager::addOutputPattern(qint64 id, const QString& pattern, int action) {
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record || action < 0 || action > int(PatternAction::Notify)) return false;
+    if (!isValidPattern(pattern)) {
+        qWarning() << "Invalid output pattern:" << pattern;
         return false;
     }
-    
-    // 如果名称改变了，检查新名称是否唯一
-    if (oldName != newName) {
-        if (!isCommandNameUnique(newName, oldName)) {
-            qWarning() << "Command name already exists:" << newName;
-            return false;
-        }
+
+    m_patterns[record->name].append({ pattern, PatternAction(action) });
+    savePatterns(record->name);
+    return true;
+}
+
+bool CommandManager::removeOutputPattern(qint64 id, int index) {
+    const CommandRecord* record = m_commandModel->record(id);
+    if (!record) return false;
+
+    const QString name = record->name;
+    auto it = m_patterns.find(name);
+    if (it == m_patterns.end() || index < 0 || index >= it->size()) return false;
+
+    it->removeAt(index);
+    if (it->isEmpty()) {
+        m_patterns.erase(it);
     }
-    
-    CommandEntry* entry = m_commandMap.value(oldName);
-    
-    // 如果命令正在运行，先停止它
-    if (entry->process && entry->process->state() != QProcess::NotRunning) {
-        stopCommand(oldName);
+    savePatterns(name);
+    return true;
+}
+
+bool CommandManager::isValidPattern(const QString& pattern) const {
+    return !pattern.isEmpty() && QRegularExpression(pattern).isValid();
+}
+
+bool CommandManager::hasReadyPattern(const QString& name) const {
+    for (const OutputPattern& p : m_patterns.value(name)) {
+        if (p.action == PatternAction::Ready) return true;
     }
-    
-    // 更新数据库
-    QSqlQuery query(m_database);
-    
-    if (oldName != newName) {
-        // 如果名称改变了，使用UPDATE更新名称和命令
-        query.prepare("UPDATE commands SET name = ?, command = ?, updated_at = datetime('now') WHERE name = ?");
-        query.addBindValue(newName);
-        query.addBindValue(newCommand);
-        query.addBindValue(oldName);
-    } else {
-        // 如果只是更新命令内容
-        query.prepare("UPDATE commands SET command = ?, updated_at = datetime('now') WHERE name = ?");
-        query.addBindValue(newCommand);
-        query.addBindValue(oldName);
+    return false;
+}
+
+void CommandManager::loadSavedPatterns() {
+    QMetaObject::invokeMethod(m_store, [store = m_store]() {
+        return store->loadPatterns();
+    }, Qt::BlockingQueuedConnection, &m_patterns);
+}
+
+void CommandManager::savePatterns(const QString& name) {
+    // 整体重写该命令的模式列表，删除和插入在同一个事务中提交
+    const QList<OutputPattern> patterns = m_patterns.value(name);
+    writeDatabase("DELETE FROM command_patterns WHERE command_name = ?", { name });
+    for (int i = 0; i < patterns.size(); ++i) {
+        writeDatabase("INSERT INTO command_patterns (command_name, position, pattern, action) VALUES (?, ?, ?, ?)",
+                      { name, i, patterns.at(i).pattern, int(patterns.at(i).action) });
     }
-    
-    if (!query.exec()) {
-        qWarning() << "Failed to update command in database:" << query.lastError().text();
+
+    // 正在运行的进程沿用启动时的模式，高亮立即对输出窗口生效
+    if (CommandEntry* entry = m_entries.value(commandId(name))) {
+        entry->setHighlightPatterns(patterns);
+    }
+}
+
+QObject* CommandManager::runHistory(qint64 id) {
+    CommandEntry* entry = entryFor(id);
+    if (!entry) return nullptr;
+
+    if (!entry->history) {
+        entry->history = new RunHistory(entry, m_store, m_archiveWorker, m_archiveDir, entry);
+        QQmlEngine::setObjectOwnership(entry->history, QQmlEngine::CppOwnership);
+    }
+    return entry->history;
+}
+
+bool CommandManager::createGroup(const QString& group, int maxConcurrency) {
+    if (group.isEmpty() || m_groups.contains(group)) {
+        qWarning() << "Group already exists or name is empty:" << group;
         return false;
     }
-    
-    // 更新内存中的数据
-    if (oldName != newName) {
-        // 从旧的映射中移除
-        m_commandMap.remove(oldName);
-        
-        // 创建新的CommandEntry
-        CommandEntry* newEntry = new CommandEntry(newName, newCommand, this);
-        m_commandMap.insert(newName, newEntry);
-        
-        // 在列表中替换
-        int index = m_commandList.indexOf(entry);
-        if (index >= 0) {
-            m_commandList.replace(index, newEntry);
+
+    writeDatabase("INSERT INTO command_groups (name, max_concurrency) VALUES (?, ?)",
+                  { group, qMax(1, maxConcurrency) });
+
+    CommandGroup g;
+    g.name = group;
+    g.maxConcurrency = qMax(1, maxConcurrency);
+    m_groups.insert(group, g);
+    emit groupsChanged();
+    return true;
+}
+
+bool CommandManager::removeGroup(const QString& group) {
+    if (!m_groups.contains(group)) return false;
+
+    // 两条删除会在同一个事务中提交
+    writeDatabase("DELETE FROM group_members WHERE group_name = ?", { group });
+    writeDatabase("DELETE FROM command_groups WHERE name = ?", { group });
+
+    m_groups.remove(group);
+    emit groupsChanged();
+    return true;
+}
+
+bool CommandManager::addGroupMember(const QString& group, const QString& command,
+                                    const QStringList& dependsOn, const QString& readyPattern, bool waitForExit) {
+    if (!m_groups.contains(group)) {
+        qWarning() << "Group not found:" << group;
+        return false;
+    }
+    if (!m_commandModel->contains(command)) {
+        qWarning() << "Command not found:" << command;
+        return false;
+    }
+
+    GroupMember member;
+    member.command = command;
+    member.dependsOn = dependsOn;
+    member.readyPattern = readyPattern;
+    member.waitForExit = waitForExit;
+
+    CommandGroup& g = m_groups[group];
+    int position = g.members.size();
+    for (int i = 0; i < g.members.size(); ++i) {
+        if (g.members[i].command == command) {
+            position = i;
+            break;
         }
-        
-        // 删除旧的entry
-        entry->deleteLater();
+    }
+
+    saveGroupMember(group, member, position);
+
+    if (position < g.members.size()) {
+        g.members[position] = member;
     } else {
-        // 只更新命令内容，需要更新CommandEntry的私有成员
-        // 由于无法直接访问私有成员，我们需要重新创建entry
-        m_commandMap.remove(oldName);
-        CommandEntry* newEntry = new CommandEntry(newName, newCommand, this);
-        m_commandMap.insert(newName, newEntry);
-        
-        int index = m_commandList.indexOf(entry);
-        if (index >= 0) {
-            m_commandList.replace(index, newEntry);
-        }
-        
-        entry->deleteLater();
+        g.members.append(member);
     }
-    
-    emit commandListChanged();
-    qDebug() << "Command edited successfully:" << oldName << "->" << newName;
+    emit groupsChanged();
     return true;
 }
 
-bool CommandManager::isCommandNameUnique(const QString& name, const QString& excludeName) {
-    // 检查内存中的命令
-    for (auto it = m_commandMap.constBegin(); it != m_commandMap.constEnd(); ++it) {
-        if (it.key() == name && it.key() != excludeName) {
-            return false;
+bool CommandManager::removeGroupMember(const QString& group, const QString& command) {
+    if (!m_groups.contains(group)) return false;
+
+    writeDatabase("DELETE FROM group_members WHERE group_name = ? AND command_name = ?", { group, command });
+
+    QList<GroupMember>& members = m_groups[group].members;
+    members.removeIf([&](const GroupMember& m) { return m.command == command; });
+    emit groupsChanged();
+    return true;
+}
+
+QStringList CommandManager::groupNames() const {
+    return m_groups.keys();
+}
+
+QVariantList CommandManager::groupMembers(const QString& group) const {
+    QVariantList result;
+    for (const GroupMember& member : m_groups.value(group).members) {
+        QVariantMap item;
+        item["command"] = member.command;
+        item["dependsOn"] = member.dependsOn;
+        item["readyPattern"] = member.readyPattern;
+        item["waitForExit"] = member.waitForExit;
+        result.append(item);
+    }
+    return result;
+}
+
+void CommandManager::startGroup(const QString& group) {
+    if (!m_groups.contains(group)) {
+        qWarning() << "Group not found:" << group;
+        return;
+    }
+    if (m_groupLaunchers.contains(group)) {
+        qDebug() << "Group already starting:" << group;
+        return;
+    }
+
+    auto* launcher = new GroupLauncher(this, m_groups.value(group), this);
+    m_groupLaunchers.insert(group, launcher);
+
+    connect(launcher, &GroupLauncher::progress, this, &CommandManager::groupProgress);
+    connect(launcher, &GroupLauncher::finished, this,
+            [this, launcher](const QString& name, bool success, qint64 wallMs, qint64 criticalMs, const QStringList& path) {
+                m_groupLaunchers.remove(name);
+                launcher->deleteLater();
+                emit groupFinished(name, success, wallMs, criticalMs, path);
+            });
+
+    launcher->start();
+}
+
+bool CommandManager::isGroupRunning(const QString& group) const {
+    return m_groupLaunchers.contains(group);
+}
+
+void CommandManager::loadSavedGroups() {
+    QList<CommandGroup> groups;
+    QMetaObject::invokeMethod(m_store, [store = m_store]() {
+        return store->loadGroups();
+    }, Qt::BlockingQueuedConnection, &groups);
+
+    for (const CommandGroup& g : groups) {
+        m_groups.insert(g.name, g);
+    }
+}
+
+void CommandManager::saveGroupMember(const QString& group, const GroupMember& member, int position) {
+    writeDatabase("INSERT OR REPLACE INTO group_members "
+                  "(group_name, command_name, position, depends_on, ready_pattern, wait_exit) "
+                  "VALUES (?, ?, ?, ?, ?, ?)",
+                  { group, member.command, position, member.dependsOn.join('\n'),
+                    member.readyPattern, member.waitForExit ? 1 : 0 });
+}
+
+void CommandManager::renameGroupMembers(const QString& oldName, const QString& newName) {
+    // 成员行的主键含命令名，先整体改名；依赖列表是文本，引用了旧名称的成员重新写入
+    writeDatabase("UPDATE group_members SET command_name = ? WHERE command_name = ?", { newName, oldName });
+    bool changed = false;
+    for (CommandGroup& g : m_groups) {
+        for (int i = 0; i < g.members.size(); ++i) {
+            GroupMember& member = g.members[i];
+            if (member.command == oldName) {
+                member.command = newName;
+                changed = true;
+            }
+            if (member.dependsOn.contains(oldName)) {
+                for (QString& dependency : member.dependsOn) {
+                    if (dependency == oldName) dependency = newName;
+                }
+                saveGroupMember(g.name, member, i);
+                changed = true;
+            }
         }
-        printf("Checking command: %s\n", qPrintable(it.key()));
     }
-    return true;
+    if (changed) {
+        emit groupsChanged();
+    }
 }
 
-QString CommandManager::getCommandContent(const QString& name) {
-    if (!m_commandMap.contains(name)) {
-        return "";
+void CommandManager::removeGroupMembers(const QString& name) {
+    // 删除命令时一并移出所有命令组，并从其他成员的依赖中去掉，避免启动时报告找不到成员
+    writeDatabase("DELETE FROM group_members WHERE command_name = ?", { name });
+    bool changed = false;
+    for (CommandGroup& g : m_groups) {
+        changed = g.members.removeIf([&](const GroupMember& m) { return m.command == name; }) > 0 || changed;
+        for (int i = 0; i < g.members.size(); ++i) {
+            GroupMember& member = g.members[i];
+            if (member.dependsOn.removeAll(name) > 0) {
+                saveGroupMember(g.name, member, i);
+                changed = true;
+            }
+        }
+    }
+    if (changed) {
+        emit groupsChanged();
     }
-    return m_commandMap[name]->command();
 }
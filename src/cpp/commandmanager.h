@@ -3,47 +3,286 @@
 #include <QObject>
 #include <QProcess>
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <QPointer>
 #include <QVariant>
 #include <QTimer>
-#include <QSqlDatabase>
-#include <QSqlQuery>
-#include <QSqlError>
+#include <QElapsedTimer>
+#include "OutputBuffer.h"
+#include "LogModel.h"
+#include "LogFilterModel.h"
+#include "OutputSearch.h"
+#include "GroupLauncher.h"
+#include "ProcessWorker.h"
+#include "CommandListModel.h"
+#include "CommandFilterModel.h"
+#include "DatabaseWorker.h"
+#include "RunHistory.h"
+#include "RestartSupervisor.h"
+#include "Tracing.h"
+
+class QThread;
 
 class CommandEntry : public QObject {
     Q_OBJECT
-    Q_PROPERTY(QString name READ name CONSTANT)
-    Q_PROPERTY(QString command READ command CONSTANT)
+    Q_PROPERTY(qint64 commandId READ id CONSTANT)
+    Q_PROPERTY(QString name READ name NOTIFY nameChanged)
+    Q_PROPERTY(QString command READ command NOTIFY commandChanged)
     Q_PROPERTY(QString cmdOutput READ cmdOutput NOTIFY outputChanged)
     Q_PROPERTY(bool isRunning READ isRunning NOTIFY runningChanged)
     Q_PROPERTY(bool isStopping READ isStopping NOTIFY stoppingChanged)
+    Q_PROPERTY(bool isStarting READ isStarting NOTIFY startingChanged)
+    Q_PROPERTY(int flushCount READ flushCount NOTIFY flushStatsChanged)
+    Q_PROPERTY(int lastFlushChunks READ lastFlushChunks NOTIFY flushStatsChanged)
+    Q_PROPERTY(int maxFlushChunks READ maxFlushChunks NOTIFY flushStatsChanged)
+    Q_PROPERTY(qint64 totalChunks READ totalChunks NOTIFY flushStatsChanged)
+    Q_PROPERTY(double cpuPercent READ cpuPercent NOTIFY metricsChanged)
+    Q_PROPERTY(qint64 rssKb READ rssKb NOTIFY metricsChanged)
+    Q_PROPERTY(qint64 peakRssKb READ peakRssKb NOTIFY metricsChanged)
+    Q_PROPERTY(qint64 ioReadBytes READ ioReadBytes NOTIFY metricsChanged)
+    Q_PROPERTY(qint64 ioWriteBytes READ ioWriteBytes NOTIFY metricsChanged)
+    Q_PROPERTY(int processCount READ processCount NOTIFY metricsChanged)
+    Q_PROPERTY(int threadCount READ threadCount NOTIFY metricsChanged)
+    Q_PROPERTY(QList<qreal> cpuHistory READ cpuHistory NOTIFY metricsChanged)
+    Q_PROPERTY(QList<qreal> rssHistory READ rssHistory NOTIFY metricsChanged)
+    Q_PROPERTY(qint64 lastLaunchUs READ lastLaunchUs NOTIFY launchMeasured)
+    Q_PROPERTY(int restartCount READ restartCount NOTIFY restartStateChanged)
+    Q_PROPERTY(QString lastExitReason READ lastExitReason NOTIFY restartStateChanged)
+    Q_PROPERTY(bool restartPending READ restartPending NOTIFY restartStateChanged)
+    Q_PROPERTY(bool restartParked READ restartParked NOTIFY restartStateChanged)
+    Q_PROPERTY(qint64 lastStopMs READ lastStopMs NOTIFY stopReported)
+    Q_PROPERTY(bool lastStopEscalated READ lastStopEscalated NOTIFY stopReported)
+    Q_PROPERTY(bool isReady READ isReady NOTIFY readyChanged)
+    Q_PROPERTY(int highlightCount READ highlightCount NOTIFY patternStateChanged)
+    Q_PROPERTY(QString lastAlert READ lastAlert NOTIFY patternStateChanged)
+    Q_PROPERTY(QString teePath READ teePath NOTIFY teeChanged)
+    Q_PROPERTY(qint64 teeBytes READ teeBytes NOTIFY teeChanged)
+    Q_PROPERTY(double teeRate READ teeRate NOTIFY teeChanged)
+    Q_PROPERTY(qint64 teeDropped READ teeDropped NOTIFY teeChanged)
+    Q_PROPERTY(QString teeError READ teeError NOTIFY teeChanged)
 
 public:
-    CommandEntry(const QString& name, const QString& command, QObject* parent = nullptr)
-        : QObject(parent), m_name(name), m_command(command), process(nullptr), m_isStopping(false) {}
-    
-    ~CommandEntry() {
-        if (stopTimer) {
-            stopTimer->stop();
-            stopTimer->deleteLater();
-        }
-        if (process) {
-            process->kill();
-            process->deleteLater();
-        }
-    }
+    CommandEntry(qint64 id, const QString& name, const QString& command, QObject* parent = nullptr)
+        : QObject(parent), m_id(id), m_name(name), m_command(command), m_isStopping(false) {}
+
+    qint64 id() const { return m_id; }
     QString name() const { return m_name; }
     QString command() const { return m_command; }
-    QString cmdOutput() const { return m_output; }    QString output() const { return m_output; }
-    bool isRunning() const { return process && process->state() == QProcess::Running; }
+    // 编辑时原地修改，输出和正在运行的进程保持不变；新命令在下次启动时生效
+    void setName(const QString& name) {
+        if (m_name == name) return;
+        m_name = name;
+        emit nameChanged();
+    }
+    void setCommand(const QString& command) {
+        if (m_command == command) return;
+        m_command = command;
+        emit commandChanged();
+    }
+    // 完整输出解码为纯文本（去掉转义序列），只在复制或整体读取时使用
+    QString cmdOutput() const { return Ansi::plainText(m_output.data()); }
+    QString output() const { return Ansi::plainText(m_output.data()); }
+    OutputBuffer& outputBuffer() { return m_output; }
+    const OutputBuffer& outputBuffer() const { return m_output; }
+    bool isRunning() const { return m_isRunning; }
     bool isStopping() const { return m_isStopping; }
-    QProcess* process = nullptr;
+    bool isStarting() const { return m_isStarting; }
+    bool isActive() const { return runId != 0; }  // 正在启动或运行中
+    quint64 runId = 0;          // 工作线程中对应进程的标识，0 表示没有进程
+    qint64 pid = 0;
+    bool m_isRunning = false;
     bool m_isStopping = false;  // 标记是否正在主动停止
-    QTimer* stopTimer = nullptr;  // 用于异步停止超时控制
+    bool m_isStarting = false;  // 已调用 start 但尚未收到 started 信号
+    LogModel* logModel = nullptr; // 输出窗口使用的行模型，按需创建
+    RunHistory* history = nullptr; // 运行历史窗口的状态，按需创建
+    LogFilterModel* stderrModel = nullptr;   // 只含 stderr 行的过滤模型，按需创建
+    OutputSearch* search = nullptr;          // 输出窗口的查找状态，按需创建
+    QString runArchive;           // 本次运行的归档文件名，对应 runs 表的 archive 列
+    qint64 runStartedAt = 0;      // 本次运行的启动时间（毫秒时间戳）
+    bool hasExited = false;       // 本次启动程序后是否结束过一次运行，下面两项才有效
+    int lastExitCode = 0;
+    int lastExitStatus = 0;
+    LaunchMode launchMode = LaunchMode::Shell;
+    QStringList argv;             // 直接启动时使用的参数，保存命令时分词一次并缓存在这里
+    bool runDirect = false;       // 本次运行是否绕过了 shell
+    RestartPolicy restartPolicy = RestartPolicy::Never;
+    qint64 teeRotateBytes = 0;    // tee 目标的轮转大小，0 表示不轮转
+    QElapsedTimer launchTimer;    // 从调用启动到进程 exec 成功的耗时
+
+    qint64 lastLaunchUs() const { return m_lastLaunchUs; }
+    void reportLaunch(qint64 us) {
+        m_lastLaunchUs = us;
+        emit launchMeasured();
+    }
+
+    // 合并刷新统计：每次刷新包含多少次管道读取
+    int flushCount() const { return m_flushCount; }
+    int lastFlushChunks() const { return m_lastFlushChunks; }
+    int maxFlushChunks() const { return m_maxFlushChunks; }
+    qint64 totalChunks() const { return m_totalChunks; }
+
+    void recordFlush(int chunks) {
+        ++m_flushCount;
+        m_lastFlushChunks = chunks;
+        m_maxFlushChunks = qMax(m_maxFlushChunks, chunks);
+        m_totalChunks += chunks;
+        emit flushStatsChanged();
+    }
+
+    // 资源占用：由工作线程按采样间隔更新，历史序列供界面绘制迷你曲线
+    static constexpr int MetricsHistorySize = 60;
+    double cpuPercent() const { return m_metrics.cpuPercent; }
+    qint64 rssKb() const { return m_metrics.rssKb; }
+    qint64 peakRssKb() const { return m_metrics.peakRssKb; }
+    qint64 ioReadBytes() const { return m_metrics.readBytes; }
+    qint64 ioWriteBytes() const { return m_metrics.writeBytes; }
+    int processCount() const { return m_metrics.processCount; }
+    int threadCount() const { return m_metrics.threadCount; }
+    QList<qreal> cpuHistory() const { return m_cpuHistory; }
+    QList<qreal> rssHistory() const { return m_rssHistory; }
+
+    void updateMetrics(const ProcessMetrics& metrics) {
+        m_metrics = metrics;
+        m_cpuHistory.append(metrics.cpuPercent);
+        m_rssHistory.append(qreal(metrics.rssKb));
+        if (m_cpuHistory.size() > MetricsHistorySize) {
+            m_cpuHistory.removeFirst();
+            m_rssHistory.removeFirst();
+        }
+        emit metricsChanged();
+    }
+
+    // 进程结束后当前值归零，保留峰值、累计 I/O 和历史曲线
+    void resetMetrics() {
+        m_metrics.cpuPercent = 0;
+        m_metrics.rssKb = 0;
+        m_metrics.processCount = 0;
+        m_metrics.threadCount = 0;
+        emit metricsChanged();
+    }
+
+    // 自动重启状态：累计重启次数、最近一次退出原因、是否正在等待重启、是否因崩溃循环而暂停
+    int restartCount() const { return m_restartCount; }
+    QString lastExitReason() const { return m_lastExitReason; }
+    bool restartPending() const { return m_restartPending; }
+    bool restartParked() const { return m_restartParked; }
+    void incrementRestartCount() {
+        ++m_restartCount;
+        emit restartStateChanged();
+    }
+    void setLastExitReason(const QString& reason) {
+        m_lastExitReason = reason;
+        emit restartStateChanged();
+    }
+    void setRestartPending(bool pending) {
+        if (m_restartPending == pending) return;
+        m_restartPending = pending;
+        emit restartStateChanged();
+    }
+    void setRestartParked(bool parked) {
+        if (m_restartParked == parked) return;
+        m_restartParked = parked;
+        emit restartStateChanged();
+    }
+
+    // 最近一次停止的实际耗时（直到整个进程树退出），以及是否升级为强制结束
+    qint64 lastStopMs() const { return m_lastStopMs; }
+    bool lastStopEscalated() const { return m_lastStopEscalated; }
+    void reportStop(qint64 elapsedMs, bool escalated) {
+        m_lastStopMs = elapsedMs;
+        m_lastStopEscalated = escalated;
+        emit stopReported();
+    }
 
-    void appendOutput(const QString& out) {
-        m_output += out;
+    // 输出模式匹配结果：是否已就绪、本次运行中高亮的行数、最近一条通知行；每次启动时清零
+    bool isReady() const { return m_isReady; }
+    int highlightCount() const { return m_highlightCount; }
+    QString lastAlert() const { return m_lastAlert; }
+    void setReady(bool ready) {
+        if (m_isReady == ready) return;
+        m_isReady = ready;
+        emit readyChanged();
+    }
+    void addHighlights(int count) {
+        m_highlightCount += count;
+        emit patternStateChanged();
+    }
+    void setLastAlert(const QString& line) {
+        m_lastAlert = line;
+        emit patternStateChanged();
+    }
+    void resetPatternState() {
+        setReady(false);
+        m_highlightCount = 0;
+        m_lastAlert.clear();
+        emit patternStateChanged();
+    }
+
+    // tee 转发：目标路径与本次运行的统计，统计由工作线程每秒报告一次，每次启动时清零
+    QString teePath() const { return m_teePath; }
+    qint64 teeBytes() const { return m_teeBytes; }
+    double teeRate() const { return m_teeRate; }
+    qint64 teeDropped() const { return m_teeDropped; }
+    QString teeError() const { return m_teeError; }
+    void setTeePath(const QString& path) {
+        if (m_teePath == path) return;
+        m_teePath = path;
+        emit teeChanged();
+    }
+    void updateTeeStats(qint64 bytes, double rate, qint64 dropped, const QString& error) {
+        m_teeBytes = bytes;
+        m_teeRate = rate;
+        m_teeDropped = dropped;
+        m_teeError = error;
+        emit teeChanged();
+    }
+    void resetTeeStats() { updateTeeStats(0, 0.0, 0, QString()); }
+
+    // 高亮模式在这里预编译一次，输出窗口只对可见行调用 isHighlighted
+    void setHighlightPatterns(const QList<OutputPattern>& patterns) {
+        m_highlights.clear();
+        for (const OutputPattern& p : patterns) {
+            if (p.action != PatternAction::Highlight) continue;
+            QRegularExpression regex(p.pattern);
+            if (!regex.isValid()) continue;
+            regex.optimize();
+            m_highlights.append(regex);
+        }
+        emit highlightPatternsChanged();
+    }
+    bool isHighlighted(const QString& line) const {
+        for (const QRegularExpression& regex : m_highlights) {
+            if (regex.match(line).hasMatch()) return true;
+        }
+        return false;
+    }
+
+    // 增量读取：返回 [offset, end) 之间的内容；raw 为 true 时保留转义序列。
+    // end 应取 outputCompleteEnd()，保证不会切开多字节字符或转义序列
+    QString outputBetween(qint64 offset, qint64 end, bool raw = false) const {
+        QByteArray data = m_output.mid(offset, end - offset);
+        return raw ? Ansi::decode(data) : Ansi::plainText(data);
+    }
+    qint64 outputStart() const { return m_output.startOffset(); }
+    qint64 outputEnd() const { return m_output.endOffset(); }
+    qint64 outputCompleteEnd() const { return m_output.completeEndOffset(); }
+
+    // segments 为空时整批按当前时间记为 stdout
+    void appendOutput(const QByteArray& out, const QList<OutputSegment>& segments = {}) {
+        TRACE_SCOPE("CommandEntry::appendOutput");
+        TRACE_COUNT("CommandEntry::appendedBytes", out.size());
+        qint64 offset = m_output.endOffset();
+        if (segments.isEmpty()) {
+            m_output.append(out);
+        } else {
+            qsizetype pos = 0;
+            for (const OutputSegment& segment : segments) {
+                m_output.append(QByteArrayView(out).sliced(pos, segment.length), segment.stream, segment.timestamp);
+                pos += segment.length;
+            }
+        }
+        emit outputAppended(offset, out.size());
         emit outputChanged();
     }
 
@@ -53,51 +292,263 @@ public:
     }
 
 signals:
+    void nameChanged();
+    void commandChanged();
     void outputChanged();
+    void outputAppended(qint64 offset, qint64 length);
     void runningChanged();
     void stoppingChanged();
+    void startingChanged();
+    void flushStatsChanged();
+    void metricsChanged();
+    void stopReported();
+    void launchMeasured();
+    void restartStateChanged();
+    void readyChanged();
+    void patternStateChanged();
+    void highlightPatternsChanged();
+    void teeChanged();
 
 private:
+    qint64 m_id;
     QString m_name;
     QString m_command;
-    QString m_output;
+    OutputBuffer m_output;
+    int m_flushCount = 0;
+    int m_lastFlushChunks = 0;
+    int m_maxFlushChunks = 0;
+    qint64 m_totalChunks = 0;
+    ProcessMetrics m_metrics;
+    QList<qreal> m_cpuHistory;
+    QList<qreal> m_rssHistory;
+    int m_restartCount = 0;
+    QString m_lastExitReason;
+    bool m_restartPending = false;
+    bool m_restartParked = false;
+    qint64 m_lastLaunchUs = -1;
+    qint64 m_lastStopMs = -1;
+    bool m_lastStopEscalated = false;
+    bool m_isReady = false;
+    int m_highlightCount = 0;
+    QString m_lastAlert;
+    QList<QRegularExpression> m_highlights;
+    QString m_teePath;
+    qint64 m_teeBytes = 0;
+    double m_teeRate = 0.0;
+    qint64 m_teeDropped = 0;
+    QString m_teeError;
 };
 
 class CommandManager : public QObject {
     Q_OBJECT
     Q_PROPERTY(QList<QObject*> commandList READ commandList NOTIFY commandListChanged)
+    Q_PROPERTY(QObject* commandModel READ commandModel CONSTANT)
+    Q_PROPERTY(QObject* commandFilter READ commandFilter CONSTANT)
+    Q_PROPERTY(bool commandsLoaded READ commandsLoaded NOTIFY commandsLoadedChanged)
+    Q_PROPERTY(qint64 outputLimitBytes READ outputLimitBytes WRITE setOutputLimitBytes NOTIFY outputLimitsChanged)
+    Q_PROPERTY(qint64 outputLimitLines READ outputLimitLines WRITE setOutputLimitLines NOTIFY outputLimitsChanged)
+    Q_PROPERTY(int outputFlushInterval READ outputFlushInterval WRITE setOutputFlushInterval NOTIFY outputFlushSettingsChanged)
+    Q_PROPERTY(int outputFlushThreshold READ outputFlushThreshold WRITE setOutputFlushThreshold NOTIFY outputFlushSettingsChanged)
+    Q_PROPERTY(qint64 flushCount READ flushCount NOTIFY flushStatsChanged)
+    Q_PROPERTY(qint64 flushedChunks READ flushedChunks NOTIFY flushStatsChanged)
+    Q_PROPERTY(int runRetentionCount READ runRetentionCount WRITE setRunRetentionCount NOTIFY runRetentionChanged)
+    Q_PROPERTY(qint64 runRetentionBytes READ runRetentionBytes WRITE setRunRetentionBytes NOTIFY runRetentionChanged)
+    Q_PROPERTY(int metricsInterval READ metricsInterval WRITE setMetricsInterval NOTIFY metricsIntervalChanged)
+    Q_PROPERTY(QVariantMap launchStats READ launchStats NOTIFY launchStatsChanged)
 
 public:
     explicit CommandManager(QObject* parent = nullptr);
-    QList<QObject*> commandList();
+    // dataPath 为 commands.db 和运行归档所在的目录，默认使用程序所在目录
+    explicit CommandManager(const QString& dataPath, QObject* parent = nullptr);
+    ~CommandManager();
+    static constexpr int CommandPageSize = 200;   // 启动时每次从数据库读取的命令数
+    static constexpr int DefaultRunRetentionCount = 50;                    // 每个命令默认保留的运行记录数
+    static constexpr qint64 DefaultRunRetentionBytes = 256 * 1024 * 1024;  // 每个命令的归档默认最多占用 256MB
+    static constexpr int StopTimeout = 3000;      // 停止时等待进程树自行退出的时间，超时后强制结束
+
+    QList<QObject*> commandList();   // 已创建的命令对象（运行过或查看过输出的命令）
+    bool commandsLoaded() const { return m_commandsLoaded; }
+    QObject* commandModel() const { return m_commandModel; }
+    QObject* commandFilter() const { return m_commandFilter; }
 
-    Q_INVOKABLE void addCommand(const QString& name, const QString& command);
-    Q_INVOKABLE void startCommand(const QString& name);
-    Q_INVOKABLE void stopCommand(const QString& name);
+    // 每个命令输出保留的上限，超出后淘汰最旧的内容
+    qint64 outputLimitBytes() const { return m_outputLimitBytes; }
+    qint64 outputLimitLines() const { return m_outputLimitLines; }
+    void setOutputLimitBytes(qint64 bytes);
+    void setOutputLimitLines(qint64 lines);
+
+    // 输出合并刷新：最多每 interval 毫秒刷新一次界面，积压超过 threshold 字节时立即刷新
+    int outputFlushInterval() const { return m_outputFlushInterval; }
+    int outputFlushThreshold() const { return m_outputFlushThreshold; }
+    void setOutputFlushInterval(int msec);
+    void setOutputFlushThreshold(int bytes);
+    qint64 flushCount() const { return m_flushCount; }
+    qint64 flushedChunks() const { return m_flushedChunks; }
+
+    // 运行历史的保留上限（0 表示不限制），每次运行结束时删除超出的最旧记录和归档
+    int runRetentionCount() const { return m_runRetentionCount; }
+    void setRunRetentionCount(int count);
+    qint64 runRetentionBytes() const { return m_runRetentionBytes; }
+    void setRunRetentionBytes(qint64 bytes);
+    // 资源采样间隔（毫秒），<= 0 时停止采样
+    int metricsInterval() const { return m_metricsInterval; }
+    void setMetricsInterval(int msec);
+
+    // 两种启动方式各自的启动耗时统计（微秒）：{ shell: {...}, direct: {...} }
+    QVariantMap launchStats() const;
+
+    // 界面按命令 id（commands.id）调用，改名后 id 不变；id 为 0 表示不存在。
+    // 控制接口、命令组等按名称调用的入口先经名称索引换成 id
+    Q_INVOKABLE qint64 commandId(const QString& name) const;
+    Q_INVOKABLE qint64 addCommand(const QString& name, const QString& command);   // 返回新命令的 id
+    Q_INVOKABLE void startCommand(qint64 id);
+    void startCommand(const QString& name);
+    Q_INVOKABLE void stopCommand(qint64 id);
+    void stopCommand(const QString& name);
     Q_INVOKABLE QString getOutput(const QString& name);
-    Q_INVOKABLE bool isRunning(const QString& name);
-    Q_INVOKABLE void clearOutput(const QString& name);
-    Q_INVOKABLE void removeCommand(const QString& name);
-    Q_INVOKABLE void saveCommand(const QString& name, const QString& command);
+    // raw 为 true 时保留 ANSI 转义序列（例如转发给终端客户端），否则返回纯文本
+    Q_INVOKABLE QVariantMap readOutput(const QString& name, qint64 fromOffset, bool raw = false);
+    Q_INVOKABLE QObject* outputModel(qint64 id);
+    Q_INVOKABLE QObject* stderrModel(qint64 id);
+    Q_INVOKABLE QObject* outputSearch(qint64 id);
+    Q_INVOKABLE void copyOutput(qint64 id);
+    Q_INVOKABLE bool isRunning(qint64 id);
+    bool isRunning(const QString& name);
+    Q_INVOKABLE void clearOutput(qint64 id);
+    Q_INVOKABLE void removeCommand(qint64 id);
     Q_INVOKABLE void loadSavedCommands();
-    Q_INVOKABLE bool editCommand(const QString& oldName, const QString& newName, const QString& newCommand);
-    Q_INVOKABLE bool isCommandNameUnique(const QString& name, const QString& excludeName = "");
-    Q_INVOKABLE QString getCommandContent(const QString& name);
+    // 原地修改名称和命令，已有输出和正在运行的进程保留
+    Q_INVOKABLE bool editCommand(qint64 id, const QString& newName, const QString& newCommand);
+    Q_INVOKABLE bool isCommandNameUnique(const QString& name, qint64 excludeId = 0);
+    Q_INVOKABLE QString getCommandContent(qint64 id);
+    QString getCommandContent(const QString& name);
+
+    // 启动方式：0 经 shell，1 直接执行；含 shell 语法的命令不能直接执行
+    Q_INVOKABLE int launchMode(qint64 id);
+    Q_INVOKABLE bool setLaunchMode(qint64 id, int mode);
+    Q_INVOKABLE bool canLaunchDirect(const QString& command) const;
+
+    // 自动重启策略：0 从不，1 失败时，2 总是
+    Q_INVOKABLE int restartPolicy(qint64 id);
+    Q_INVOKABLE bool setRestartPolicy(qint64 id, int policy);
+
+    // tee 转发：原始输出同时写入文件或 FIFO，path 为空表示关闭；rotateBytes > 0 时按大小轮转。
+    // 修改在下次启动时生效。返回 { path, rotateBytes, bytes, rate, dropped, error }
+    Q_INVOKABLE QVariantMap teeTarget(qint64 id) const;
+    Q_INVOKABLE bool setTeeTarget(qint64 id, const QString& path, qint64 rotateBytes = 0);
+
+    // 输出模式：在输出流上增量匹配，action 为 0 就绪、1 高亮、2 托盘通知
+    Q_INVOKABLE QVariantList outputPatterns(qint64 id) const;
+    Q_INVOKABLE bool addOutputPattern(qint64 id, const QString& pattern, int action);
+    Q_INVOKABLE bool removeOutputPattern(qint64 id, int index);
+    Q_INVOKABLE bool isValidPattern(const QString& pattern) const;
+    bool hasReadyPattern(const QString& name) const;
+
+    // 供控制接口使用：所有命令名，以及单个命令的状态
+    // { state: stopped/starting/running/stopping, pid, ready, restartCount, lastExitReason }，
+    // 结束过的命令另有最近一次运行的 exitCode、exitStatus
+    QStringList commandNames() const { return m_commandModel->names(); }
+    QVariantMap commandStatus(const QString& name) const;
+
+    // 供自动重启使用：与 startCommand 相同，但不清除崩溃循环状态
+    void restartCommand(qint64 id);
+
+    // 运行历史：每次运行的输出都压缩归档到磁盘，由返回的 RunHistory 在后台分页读取和搜索
+    Q_INVOKABLE QObject* runHistory(qint64 id);
+
+    // 命令组：按依赖顺序和并发上限批量启动
+    Q_INVOKABLE bool createGroup(const QString& group, int maxConcurrency = 4);
+    Q_INVOKABLE bool removeGroup(const QString& group);
+    Q_INVOKABLE bool addGroupMember(const QString& group, const QString& command,
+                                    const QStringList& dependsOn = QStringList(),
+                                    const QString& readyPattern = "", bool waitForExit = false);
+    Q_INVOKABLE bool removeGroupMember(const QString& group, const QString& command);
+    Q_INVOKABLE QStringList groupNames() const;
+    Q_INVOKABLE QVariantList groupMembers(const QString& group) const;
+    Q_INVOKABLE void startGroup(const QString& group);
+    Q_INVOKABLE bool isGroupRunning(const QString& group) const;
 
 signals:
     void commandListChanged();
+    void commandsLoadedChanged();
     void outputUpdated(const QString& name);
     void commandStatusChanged(const QString& name, bool running);
+    void commandFinished(const QString& name, int exitCode, int exitStatus);
+    void commandStopped(const QString& name, qint64 elapsedMs, bool escalated, int survivors);
+    void commandReady(const QString& name);
+    void commandAlert(const QString& name, const QString& line);
+    void groupsChanged();
+    void groupProgress(const QString& group, int ready, int total);
+    void groupFinished(const QString& group, bool success, qint64 wallTimeMs,
+                       qint64 criticalPathMs, const QStringList& criticalPath);
+    void outputLimitsChanged();
+    void outputFlushSettingsChanged();
+    void flushStatsChanged();
+    void runRetentionChanged();
+    void metricsIntervalChanged();
+    void launchStatsChanged();
 
 private:
-    QMap<QString, CommandEntry*> m_commandMap;
-    QList<QObject*> m_commandList;
-    QSqlDatabase m_database;
-
-    void handleProcessOutput(CommandEntry* entry);
-    void handleProcessError(CommandEntry* entry, QProcess::ProcessError error);
-    void handleProcessFinished(CommandEntry* entry, int exitCode, QProcess::ExitStatus exitStatus);
-    void forceKillProcess(CommandEntry* entry);  // 强制杀死进程的辅助方法
-    bool initializeDatabase();
-    bool createCommandFromDatabase(const QString& name, const QString& command);
+    QHash<qint64, CommandEntry*> m_entries;          // id -> 已创建的 CommandEntry
+    qint64 m_lastLoadedId = 0;
+    qint64 m_lastCommandId = 0;                      // 已分配的最大命令 id
+    bool m_commandsLoaded = false;
+    CommandListModel* m_commandModel = nullptr;
+    CommandFilterModel* m_commandFilter = nullptr;   // 带模糊搜索的列表视图
+    QThread* m_storeThread = nullptr;
+    DatabaseWorker* m_store = nullptr;               // SQLite 读写在独立线程中批量进行
+    QString m_archiveDir;                            // 运行输出归档目录，与 commands.db 相邻
+    qint64 m_outputLimitBytes = OutputBuffer::DefaultMaxBytes;
+    qint64 m_outputLimitLines = OutputBuffer::DefaultMaxLines;
+    QThread* m_workerThread = nullptr;
+    ProcessWorker* m_worker = nullptr;               // 进程 I/O 在工作线程中处理
+    QThread* m_archiveThread = nullptr;
+    RunArchiveWorker* m_archiveWorker = nullptr;     // 运行归档的读取和搜索在独立线程中进行，所有命令共用
+    QThread* m_searchThread = nullptr;
+    SearchWorker* m_searchWorker = nullptr;          // 输出查找在独立线程中进行，所有命令共用
+    QHash<quint64, QPointer<CommandEntry>> m_runs;   // runId -> 命令
+    QHash<quint64, QPointer<CommandEntry>> m_stoppingRuns;  // 正在等待进程树退出的运行
+    quint64 m_nextRunId = 1;
+    int m_outputFlushInterval = 16;                   // 约一帧
+    int m_outputFlushThreshold = 256 * 1024;
+    qint64 m_flushCount = 0;
+    qint64 m_flushedChunks = 0;
+    int m_runRetentionCount = DefaultRunRetentionCount;
+    qint64 m_runRetentionBytes = DefaultRunRetentionBytes;
+    int m_metricsInterval = 1000;
+    struct LaunchStats {
+        qint64 count = 0;
+        qint64 totalUs = 0;
+        qint64 minUs = 0;
+        qint64 maxUs = 0;
+    };
+    LaunchStats m_launchStats[2];   // 按 LaunchMode 索引
+    QMap<QString, CommandGroup> m_groups;
+    QMap<QString, GroupLauncher*> m_groupLaunchers;  // 正在启动的命令组
+    RestartSupervisor* m_supervisor = nullptr;
+    QHash<QString, QList<OutputPattern>> m_patterns;   // 命令名 -> 输出模式
+
+    void handleProcessStarted(quint64 runId, qint64 pid);
+    void handleProcessOutput(quint64 runId, const QByteArray& data, const QList<OutputSegment>& segments, int chunks);
+    void handleMetrics(const QList<ProcessMetrics>& metrics);
+    void handlePatternsMatched(quint64 runId, const QList<PatternHit>& hits, int highlights);
+    void handleProcessFailed(quint64 runId, const QString& error);
+    void handleProcessError(quint64 runId, int error);
+    void handleProcessFinished(quint64 runId, int exitCode, int exitStatus, qint64 peakRssKb, qint64 outputBytes);
+    void finishRun(CommandEntry* entry, int exitCode, int exitStatus, qint64 peakRssKb, qint64 outputBytes);
+    void releaseEntry(CommandEntry* entry);
+    void launchCommand(CommandEntry* entry);
+    void handleProcessStopped(quint64 runId, qint64 elapsedMs, bool escalated, int survivors);
+    void handleTeeStats(quint64 runId, qint64 bytes, double mbPerSec, qint64 dropped, const QString& error);
+    bool initializeDatabase(const QString& dataPath);
+    void loadSavedGroups();
+    void loadSavedPatterns();
+    void savePatterns(const QString& name);
+    void saveGroupMember(const QString& group, const GroupMember& member, int position);
+    void renameGroupMembers(const QString& oldName, const QString& newName);
+    void removeGroupMembers(const QString& name);
+    void writeDatabase(const QString& sql, const QVariantList& values);
+    void handleCommandPage(const QList<StoredCommand>& commands, bool finished);
+    CommandEntry* entryFor(qint64 id);
+    CommandEntry* createEntry(const CommandRecord& record);
 };
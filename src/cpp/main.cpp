@@ -4,9 +4,95 @@
 #include <QQuickStyle>
 #include "CommandManager.h"
 #include "TrayManager.h"
+#include "ControlServer.h"
+#include "ControlClient.h"
+#include "Tracing.h"
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+int signalPipe[2] = { -1, -1 };
+
+// 信号处理函数里只写管道，真正的退出在事件循环中进行，保证进程树和数据库都被正常关闭
+void handleQuitSignal(int)
+{
+    char c = 1;
+    (void)::write(signalPipe[0], &c, 1);
+}
+
+void installQuitHandler(QCoreApplication &app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalPipe) != 0) return;
+    auto *notifier = new QSocketNotifier(signalPipe[1], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, [&app]() {
+        char c;
+        (void)::read(signalPipe[1], &c, 1);
+        app.quit();
+    });
+    std::signal(SIGTERM, handleQuitSignal);
+    std::signal(SIGINT, handleQuitSignal);
+}
+}
+#endif
+
+// 命令管理器加载完命令后再开始接受控制请求
+static void startControlServer(CommandManager &manager, ControlServer &server, const QString &name)
+{
+    if (manager.commandsLoaded()) {
+        server.listen(name);
+        return;
+    }
+    QObject::connect(&manager, &CommandManager::commandsLoadedChanged, &server, [&server, name]() {
+        server.listen(name);
+    }, Qt::SingleShotConnection);
+}
+
+// 无界面模式：不创建 QML 引擎和托盘，只通过控制接口操作
+static int runHeadless(int argc, char *argv[], const QString &serverName)
+{
+    QCoreApplication app(argc, argv);
+#ifdef Q_OS_UNIX
+    installQuitHandler(app);
+#endif
+
+    CommandManager commandManager;
+    ControlServer controlServer(&commandManager);
+    controlServer.setShutdownAllowed(true);
+    QObject::connect(&controlServer, &ControlServer::shutdownRequested, &app, &QCoreApplication::quit,
+                     Qt::QueuedConnection);
+    startControlServer(commandManager, controlServer, serverName);
+
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    // 在创建应用对象之前解析参数：控制客户端和无界面模式都不需要 GUI
+    QString serverName = ControlServer::defaultServerName();
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--socket" && i + 1 < argc) {
+            serverName = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--ctl") {
+            QStringList request;
+            for (int j = i + 1; j < argc; ++j) {
+                request.append(QString::fromLocal8Bit(argv[j]));
+            }
+            QCoreApplication app(argc, argv);
+            return ControlClient::run(serverName, request);
+        }
+    }
+    if (headless) {
+        return runHeadless(argc, argv, serverName);
+    }
+
     QApplication app(argc, argv);
     
     // 设置应用图标
@@ -21,8 +107,15 @@ int main(int argc, char *argv[])
     TrayManager trayManager;    // 注册到 QML 上下文 —— 必须在 loadFromModule 之前
     engine.rootContext()->setContextProperty("commandManager", &commandManager);
     engine.rootContext()->setContextProperty("trayManager", &trayManager);
+    Tracing::TraceController traceController;
+    engine.rootContext()->setContextProperty("traceController", &traceController);
       // 连接托盘管理器信号
     QObject::connect(&trayManager, &TrayManager::exitApplication, &app, &QApplication::quit);
+    // 输出命中通知模式时弹出托盘消息
+    QObject::connect(&commandManager, &CommandManager::commandAlert, &trayManager,
+                     [&trayManager](const QString &name, const QString &line) {
+                         trayManager.showNotification(name, line);
+                     });
     
     QObject::connect(
         &engine,
@@ -46,6 +139,10 @@ int main(int argc, char *argv[])
         });
     }
 
+    // 界面模式下同样提供控制接口，脚本可以操作正在显示的启动器
+    ControlServer controlServer(&commandManager);
+    startControlServer(commandManager, controlServer, serverName);
+
     // 显示系统托盘图标（如果可用）
     if (trayManager.isTrayAvailable()) {
         trayManager.showTrayIcon();
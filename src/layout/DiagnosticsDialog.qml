@@ -0,0 +1,129 @@
+import QtQuick
+import QtQuick.Controls.Material
+import QtQuick.Controls
+import QtQuick.Layouts
+
+// 诊断面板：热路径计时与计数的实时汇总，以及 Chrome trace 导出
+ApplicationWindow {
+    id: diagnosticsWindow
+    property var rows: []
+    property string exportedPath: ""
+
+    width: 820
+    height: 560
+    title: "诊断"
+    visible: false
+
+    Material.theme: Material.Light
+    Material.primary: Material.Blue
+    Material.accent: Material.LightBlue
+    color: Material.backgroundColor
+
+    function showDiagnostics() {
+        refresh()
+        show()
+        raise()
+        requestActivate()
+    }
+
+    function refresh() {
+        rows = traceController.snapshot()
+    }
+
+    // 只在窗口可见时刷新
+    Timer {
+        interval: 1000
+        repeat: true
+        running: diagnosticsWindow.visible && traceController.enabled
+        onTriggered: diagnosticsWindow.refresh()
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 16
+        spacing: 12
+
+        Label {
+            visible: !traceController.available
+            text: "构建时未启用插桩（RCMDLAUNCH_TRACING）"
+            color: Material.color(Material.Red)
+        }
+
+        RowLayout {
+            spacing: 12
+            enabled: traceController.available
+
+            Switch {
+                text: "统计"
+                checked: traceController.enabled
+                onToggled: traceController.enabled = checked
+            }
+
+            Switch {
+                text: "录制事件"
+                checked: traceController.recording
+                onToggled: traceController.recording = checked
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: "清空"
+                onClicked: {
+                    traceController.reset()
+                    diagnosticsWindow.refresh()
+                }
+            }
+
+            Button {
+                text: "导出 Trace"
+                Material.background: Material.primary
+                Material.foreground: "white"
+                onClicked: diagnosticsWindow.exportedPath = traceController.exportTrace()
+            }
+        }
+
+        Label {
+            visible: diagnosticsWindow.exportedPath !== ""
+            text: "已导出: " + diagnosticsWindow.exportedPath + "（可在 chrome://tracing 或 Perfetto 中打开）"
+            font.pointSize: 10
+            color: Material.hintTextColor
+            elide: Text.ElideMiddle
+            Layout.fillWidth: true
+        }
+
+        // 表头
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: 8
+            Label { text: "名称"; Layout.fillWidth: true; font.bold: true }
+            Label { text: "线程"; Layout.preferredWidth: 110; font.bold: true }
+            Label { text: "次数"; Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight; font.bold: true }
+            Label { text: "总计 ms"; Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight; font.bold: true }
+            Label { text: "平均 µs"; Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight; font.bold: true }
+            Label { text: "最大 µs"; Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight; font.bold: true }
+            Label { text: "累计值"; Layout.preferredWidth: 100; horizontalAlignment: Text.AlignRight; font.bold: true }
+        }
+
+        ListView {
+            id: statsView
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: diagnosticsWindow.rows
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: RowLayout {
+                width: statsView.width
+                spacing: 8
+                Label { text: modelData.name; Layout.fillWidth: true; elide: Text.ElideRight; font.family: "Consolas" }
+                Label { text: modelData.thread; Layout.preferredWidth: 110; color: Material.hintTextColor }
+                Label { text: modelData.count; Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight }
+                Label { text: modelData.totalMs.toFixed(1); Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight }
+                Label { text: modelData.avgUs.toFixed(1); Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight }
+                Label { text: modelData.maxUs.toFixed(0); Layout.preferredWidth: 80; horizontalAlignment: Text.AlignRight }
+                Label { text: modelData.value > 0 ? modelData.value : ""; Layout.preferredWidth: 100; horizontalAlignment: Text.AlignRight }
+            }
+        }
+    }
+}
@@ -9,16 +9,31 @@ Dialog {
     modal: true
     anchors.centerIn: parent
     width: 500
-    height: 500
+    height: 700
     
+    property real commandId: 0
     property string originalName: ""
     property string originalCommand: ""
+    property var patterns: []
+    // 顺序与 PatternAction 的取值一致
+    readonly property var actionNames: ["就绪", "高亮", "通知"]
+
+    function refreshPatterns() {
+        patterns = commandManager.outputPatterns(commandId)
+    }
     
-    function openEditDialog(name, command) {
+    function openEditDialog(id, name, command) {
+        commandId = id
         originalName = name
         originalCommand = command
         nameField.text = name
         commandField.text = command
+        directCheck.checked = commandManager.launchMode(id) === 1
+        restartCombo.currentIndex = commandManager.restartPolicy(id)
+        var tee = commandManager.teeTarget(id)
+        teePathField.text = tee.path || ""
+        teeRotateField.text = tee.rotateBytes > 0 ? String(Math.round(tee.rotateBytes / (1024 * 1024))) : ""
+        refreshPatterns()
         nameField.forceActiveFocus()
         open()
     }
@@ -67,6 +82,126 @@ Dialog {
                 }
             }
             
+            // 不含管道、重定向、变量等 shell 语法的命令可以跳过 shell 直接执行
+            CheckBox {
+                id: directCheck
+                text: "直接执行（不经过 shell）"
+                enabled: commandManager.canLaunchDirect(commandField.text.trim())
+            }
+
+            RowLayout {
+                spacing: 12
+
+                Label {
+                    text: "自动重启:"
+                    font.pointSize: 12
+                }
+
+                // 顺序与 RestartPolicy 的取值一致
+                ComboBox {
+                    id: restartCombo
+                    Layout.preferredWidth: 160
+                    model: ["从不", "失败时", "总是"]
+                }
+            }
+
+            // tee 转发：原始输出同时写入文件或 FIFO，下次启动时生效
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 8
+
+                Label {
+                    text: "转发到:"
+                    font.pointSize: 12
+                }
+
+                TextField {
+                    id: teePathField
+                    Layout.fillWidth: true
+                    Material.containerStyle: Material.Outlined
+                    placeholderText: "文件或 FIFO 路径，留空不转发"
+                }
+
+                TextField {
+                    id: teeRotateField
+                    Layout.preferredWidth: 110
+                    Material.containerStyle: Material.Outlined
+                    placeholderText: "轮转 MB"
+                    enabled: teePathField.text.trim().length > 0
+                    validator: IntValidator { bottom: 0 }
+                }
+            }
+
+            // 输出模式：增删立即保存，下次启动时生效（高亮立即生效）
+            Label {
+                text: "输出模式:"
+                font.pointSize: 12
+            }
+
+            ListView {
+                id: patternList
+                Layout.fillWidth: true
+                Layout.preferredHeight: Math.min(contentHeight, 96)
+                clip: true
+                model: editDialog.patterns
+
+                delegate: RowLayout {
+                    width: patternList.width
+                    spacing: 8
+
+                    Label {
+                        text: editDialog.actionNames[modelData.action]
+                        Layout.preferredWidth: 40
+                        color: Material.hintTextColor
+                    }
+
+                    Label {
+                        text: modelData.pattern
+                        Layout.fillWidth: true
+                        elide: Text.ElideRight
+                        font.family: "Consolas"
+                    }
+
+                    ToolButton {
+                        text: "✕"
+                        onClicked: {
+                            commandManager.removeOutputPattern(editDialog.commandId, index)
+                            editDialog.refreshPatterns()
+                        }
+                    }
+                }
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 8
+
+                TextField {
+                    id: patternField
+                    Layout.fillWidth: true
+                    Material.containerStyle: Material.Outlined
+                    placeholderText: "正则表达式，例如 Listening on|FATAL"
+                }
+
+                ComboBox {
+                    id: actionCombo
+                    Layout.preferredWidth: 100
+                    model: editDialog.actionNames
+                    currentIndex: 1
+                }
+
+                Button {
+                    text: "添加"
+                    enabled: commandManager.isValidPattern(patternField.text)
+                    onClicked: {
+                        if (commandManager.addOutputPattern(editDialog.commandId, patternField.text, actionCombo.currentIndex)) {
+                            patternField.text = ""
+                            editDialog.refreshPatterns()
+                        }
+                    }
+                }
+            }
+
             Label {
                 id: errorLabel
                 text: "命令名称已存在，请使用其他名称"
@@ -90,14 +225,18 @@ Dialog {
         }
         
         // 检查名称是否唯一（排除自己）
-        if (newName !== originalName && !commandManager.isCommandNameUnique(newName, originalName)) {
+        if (newName !== originalName && !commandManager.isCommandNameUnique(newName, commandId)) {
             errorLabel.text = "命令名称已存在，请使用其他名称"
             errorLabel.visible = true
             return
         }
         
         // 执行编辑
-        if (commandManager.editCommand(originalName, newName, newCommand)) {
+        if (commandManager.editCommand(commandId, newName, newCommand)) {
+            commandManager.setLaunchMode(commandId, directCheck.checked && directCheck.enabled ? 1 : 0)
+            commandManager.setRestartPolicy(commandId, restartCombo.currentIndex)
+            commandManager.setTeeTarget(commandId, teePathField.text.trim(),
+                                        (parseInt(teeRotateField.text) || 0) * 1024 * 1024)
             close()
         } else {
             errorLabel.text = "保存失败，请重试"
@@ -110,8 +249,16 @@ Dialog {
     }
     
     onClosed: {
+        commandId = 0
         nameField.text = ""
         commandField.text = ""
+        directCheck.checked = false
+        restartCombo.currentIndex = 0
+        teePathField.text = ""
+        teeRotateField.text = ""
+        patternField.text = ""
+        actionCombo.currentIndex = 1
+        patterns = []
         errorLabel.visible = false
     }
 }
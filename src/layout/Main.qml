@@ -141,11 +141,32 @@ ApplicationWindow {
             anchors.fill: parent
             spacing: 16
             
-            Label {
-                text: "命令列表"
-                font.pointSize: 16
-                font.weight: Font.Medium
-                color: Material.foreground
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 16
+
+                Label {
+                    text: "命令列表"
+                    font.pointSize: 16
+                    font.weight: Font.Medium
+                    color: Material.foreground
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Button {
+                    text: "诊断"
+                    flat: true
+                    onClicked: diagnosticsDialog.showDiagnostics()
+                }
+
+                // 输入即过滤，按名称和命令内容模糊匹配
+                TextField {
+                    id: searchField
+                    placeholderText: "搜索命令"
+                    Layout.preferredWidth: 260
+                    onTextChanged: commandManager.commandFilter.filterText = text
+                }
             }            // 使用ScrollView包装ListView以支持滚动
             ScrollView {
                 Layout.fillWidth: true
@@ -157,36 +178,14 @@ ApplicationWindow {
                     anchors.fill: parent
                     spacing: 8
 
-                    // 使用Instantiator来创建模型
-                    model: ListModel {
-                        id: commandListModel
-                    }
-
-                    // 监听commandManager的变化并更新模型
-                    Connections {
-                        target: commandManager
-                        function onCommandListChanged() {
-                            commandListModel.clear()
-                            var list = commandManager.commandList
-                            for (var i = 0; i < list.length; i++) {
-                                commandListModel.append({"cmd": list[i]})
-                            }
-                        }
-                    }
-
-                    Component.onCompleted: {
-                        // 初始加载
-                        var list = commandManager.commandList
-                        for (var i = 0; i < list.length; i++) {
-                            commandListModel.append({"cmd": list[i]})
-                        }
-                    }
+                    // C++ 端的列表模型只发出增删改对应行的通知，编辑时不会重建全部委托
+                    model: commandManager.commandFilter
 
                     delegate: Pane {
                         width: listView.width
                         Material.elevation: 2
                         
-                        property var cmd: model.cmd
+                        // 命令在运行或查看输出前只有轻量记录，状态通过模型角色读取
 
                         RowLayout {
                             anchors.fill: parent
@@ -197,19 +196,83 @@ ApplicationWindow {
                                 Layout.fillWidth: true
                                 spacing: 4
                                   Label {
-                                    text: cmd.name
+                                    text: model.name
                                     font.pointSize: 14
                                     font.weight: Font.Medium
                                     color: Material.foreground
                                 }
                                 
                                 Label {
-                                    text: cmd.command
+                                    text: model.command
                                     font.pointSize: 11
                                     color: Material.hintTextColor
                                     elide: Text.ElideRight
                                     Layout.fillWidth: true
                                 }
+
+                                // 输出模式：就绪状态和高亮行数
+                                Label {
+                                    visible: model.isRunning && (model.isReady || model.highlightCount > 0)
+                                    text: (model.isReady ? "已就绪" : "") +
+                                          (model.isReady && model.highlightCount > 0 ? " · " : "") +
+                                          (model.highlightCount > 0 ? model.highlightCount + " 行需关注" : "")
+                                    font.pointSize: 10
+                                    color: model.highlightCount > 0 ? Material.color(Material.Red) : Material.color(Material.Green)
+                                }
+
+                                // 自动重启状态
+                                Label {
+                                    visible: model.restartParked || model.restartPending || model.restartCount > 0
+                                    text: model.restartParked ? "频繁崩溃，已暂停自动重启"
+                                          : (model.restartPending ? "等待自动重启…" : "已自动重启 " + model.restartCount + " 次")
+                                    font.pointSize: 10
+                                    color: model.restartParked ? Material.color(Material.Red) : Material.hintTextColor
+                                }
+                            }
+
+                            // 资源占用：进程树的 CPU、内存及最近一段时间的内存曲线
+                            ColumnLayout {
+                                visible: model.isRunning
+                                spacing: 2
+
+                                Label {
+                                    text: "CPU " + model.cpuPercent.toFixed(0) + "% · " + (model.rssKb / 1024).toFixed(1) + " MB"
+                                    font.pointSize: 10
+                                    color: Material.hintTextColor
+                                }
+
+                                // tee 转发速率
+                                Label {
+                                    visible: model.teePath !== ""
+                                    text: "tee " + model.teeRate.toFixed(1) + " MB/s"
+                                    font.pointSize: 10
+                                    color: Material.hintTextColor
+                                }
+
+                                Canvas {
+                                    id: rssSparkline
+                                    Layout.preferredWidth: 90
+                                    Layout.preferredHeight: 18
+                                    property var points: model.rssHistory || []
+                                    onPointsChanged: requestPaint()
+
+                                    onPaint: {
+                                        var ctx = getContext("2d")
+                                        ctx.clearRect(0, 0, width, height)
+                                        if (points.length < 2) return
+                                        var max = Math.max.apply(null, points) || 1
+                                        ctx.strokeStyle = Material.accent
+                                        ctx.lineWidth = 1
+                                        ctx.beginPath()
+                                        for (var i = 0; i < points.length; ++i) {
+                                            var x = width * i / (points.length - 1)
+                                            var y = height - 1 - (height - 2) * points[i] / max
+                                            if (i === 0) ctx.moveTo(x, y)
+                                            else ctx.lineTo(x, y)
+                                        }
+                                        ctx.stroke()
+                                    }
+                                }
                             }
 
                             // 状态指示器
@@ -217,10 +280,10 @@ ApplicationWindow {
                                 Layout.preferredWidth: 12
                                 Layout.preferredHeight: 12
                                 radius: 6
-                                color: cmd.isRunning ? Material.color(Material.Green) : Material.color(Material.Red)
-                                opacity: cmd.isRunning ? 1.0: 1.0
+                                color: model.isRunning ? Material.color(Material.Green) : Material.color(Material.Red)
+                                opacity: model.isRunning ? 1.0: 1.0
                                 SequentialAnimation on opacity {
-                                    running: cmd.isRunning
+                                    running: model.isRunning
                                     loops: Animation.Infinite
                                     NumberAnimation { to: 0.3; duration: 800 }
                                     NumberAnimation { to: 1.0; duration: 800 }
@@ -229,24 +292,25 @@ ApplicationWindow {
                             RowLayout {
                                 spacing: 8
 
-                                // Loading指示器 - 在停止时显示
+                                // Loading指示器 - 在启动或停止过程中显示
                                 BusyIndicator {
                                     id: loadingIndicator
                                     Layout.preferredWidth: 24
                                     Layout.preferredHeight: 24
-                                    visible: cmd.isRunning && cmd.isStopping
+                                    visible: model.isStarting || (model.isRunning && model.isStopping)
                                     running: visible
                                     Material.accent: Material.primary
                                 }
                                 Button {
-                                    text: cmd.isRunning ? "停止" : "启动"
-                                    Material.background: cmd.isRunning ? Material.Red : Material.Green
+                                    text: model.isStarting ? "启动中" : (model.isRunning ? "停止" : "启动")
+                                    enabled: !model.isStarting
+                                    Material.background: model.isRunning ? Material.Red : Material.Green
                                     Material.foreground: "white"
                                     onClicked: {
-                                        if (cmd.isRunning)
-                                            commandManager.stopCommand(cmd.name)
+                                        if (model.isRunning)
+                                            commandManager.stopCommand(model.commandId)
                                         else
-                                            commandManager.startCommand(cmd.name)
+                                            commandManager.startCommand(model.commandId)
                                     }
                                 }                            
                                 
@@ -254,7 +318,7 @@ ApplicationWindow {
                                     text: "详情"
                                     Material.background: Material.primary
                                     Material.foreground: "white"
-                                    onClicked: mainWindow.getOutputDialog(cmd.name).showOutput(cmd.name)
+                                    onClicked: mainWindow.getOutputDialog(model.commandId).showOutput(model.commandId, model.name)
                                 }
                                   // 三个点的菜单按钮
                                 Button {
@@ -264,24 +328,26 @@ ApplicationWindow {
                                     Material.foreground: "white"
                                     Layout.preferredWidth: 36
                                     Layout.preferredHeight: 36
-                                    property string cmdName: cmd.name
+                                    property real cmdId: model.commandId
+                                    property string cmdName: model.name
                                     
                                     onClicked: {
+                                        commandMenu.cmdId = cmdId
                                         commandMenu.cmdName = cmdName
                                         commandMenu.popup()
                                     }
                                     
                                     Menu {
                                         id: commandMenu
+                                        property real cmdId: 0
                                         property string cmdName: ""
                                         
                                         MenuItem {
                                             text: "编辑"
                                             icon.source: "/edit.png"
                                             onTriggered: {
-                                                var cmdName = commandMenu.cmdName
-                                                var cmdContent = commandManager.getCommandContent(cmdName)
-                                                editDialog.openEditDialog(cmdName, cmdContent)
+                                                var cmdContent = commandManager.getCommandContent(commandMenu.cmdId)
+                                                editDialog.openEditDialog(commandMenu.cmdId, commandMenu.cmdName, cmdContent)
                                             }
                                         }
                                         
@@ -289,7 +355,8 @@ ApplicationWindow {
                                             text: "删除"
                                             icon.source: "/delete.png"
                                             onTriggered: {
-                                                deleteConfirmDialog.commandToDelete = commandMenu.cmdName
+                                                deleteConfirmDialog.commandToDelete = commandMenu.cmdId
+                                                deleteConfirmDialog.commandName = commandMenu.cmdName
                                                 deleteConfirmDialog.open()
                                             }
                                         }
@@ -315,31 +382,37 @@ ApplicationWindow {
         id: editDialog
     }
 
+    // 诊断面板
+    DiagnosticsDialog {
+        id: diagnosticsDialog
+    }
+
     // 存储每个命令的OutputDialog实例
     property var outputDialogs: ({})
     property int nextWindowIndex: 0
     
-    // 为指定命令创建或获取OutputDialog实例
-    function getOutputDialog(commandName) {
-        if (!outputDialogs[commandName]) {
+    // 为指定命令创建或获取OutputDialog实例，按命令 id 区分，改名后仍是同一个窗口
+    function getOutputDialog(commandId) {
+        if (!outputDialogs[commandId]) {
             var dialog = outputDialogComponent.createObject(null)
             dialog.windowIndex = nextWindowIndex
             nextWindowIndex = (nextWindowIndex + 1) % 10  // 最多10个不同位置，然后循环
-            outputDialogs[commandName] = dialog
+            outputDialogs[commandId] = dialog
         }
-        return outputDialogs[commandName]
+        return outputDialogs[commandId]
     }
     
     // 清理所有OutputDialog实例
     function cleanupOutputDialogs() {
-        for (var commandName in outputDialogs) {
-            if (outputDialogs[commandName]) {
-                outputDialogs[commandName].destroy()
+        for (var commandId in outputDialogs) {
+            if (outputDialogs[commandId]) {
+                outputDialogs[commandId].destroy()
             }
         }
         outputDialogs = {}
     }    // 应用退出时清理
     Component.onDestruction: {
+        diagnosticsDialog.close()
         cleanupOutputDialogs()
     }
     
@@ -351,22 +424,23 @@ ApplicationWindow {
         modal: true
         standardButtons: Dialog.Yes | Dialog.No
         
-        property string commandToDelete: ""
+        property real commandToDelete: 0
+        property string commandName: ""
         
         Label {
-            text: "确定要删除命令 \"" + deleteConfirmDialog.commandToDelete + "\" 吗？\n此操作不可撤销。"
+            text: "确定要删除命令 \"" + deleteConfirmDialog.commandName + "\" 吗？\n此操作不可撤销。"
             wrapMode: Text.WordWrap
         }
         
         onAccepted: {
             if (commandToDelete) {
                 commandManager.removeCommand(commandToDelete)
-                commandToDelete = ""
+                commandToDelete = 0
             }
         }
         
         onRejected: {
-            commandToDelete = ""
+            commandToDelete = 0
         }
     }
 }
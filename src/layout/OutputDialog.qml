@@ -5,13 +5,16 @@ import QtQuick.Layouts
 
 ApplicationWindow {
     id: outputWindow
+    property real commandId: 0
     property string currentCommand
     property bool autoScroll: true
+    property bool showTimestamps: false
+    property bool stderrOnly: false
     
     // 组件初始化状态
     property bool componentReady: false
 
-    width: 800
+    width: 960
     height: 600
     title: currentCommand ? "控制台输出 - " + currentCommand : "控制台输出"
     visible: false
@@ -33,7 +36,17 @@ ApplicationWindow {
         componentReady = true
     }
 
-    function showOutput(name) {
+    // 当前命令的行模型，由 C++ 端按输出缓冲的行索引提供；只看 stderr 时换成过滤模型
+    property var logModel: null
+    // 当前命令的查找状态，在后台线程中搜索全部保留的输出
+    property var search: null
+    property string searchedQuery: ""
+    // 当前匹配在视图中的行，stderr 过滤时换算到过滤模型
+    property int matchRow: search && search.currentRow >= 0
+                           ? (stderrOnly ? logModel.rowForSource(search.currentRow) : search.currentRow) : -1
+
+    function showOutput(id, name) {
+        commandId = id
         currentCommand = name
         updateOutput()
 
@@ -46,26 +59,52 @@ ApplicationWindow {
     }    
     
     function updateOutput() {
-        if (currentCommand && commandManager && componentReady) {
-            var newText = commandManager.getOutput(currentCommand)
-            if (textArea) {
-                textArea.text = newText
-                
-                // 自动滚动到底部（如果启用）
-                if (autoScroll && newText.length > 0) {
-                    textArea.cursorPosition = textArea.length
-                }
-            }
+        if (commandId && commandManager && componentReady) {
+            logModel = stderrOnly ? commandManager.stderrModel(commandId)
+                                  : commandManager.outputModel(commandId)
+            search = commandManager.outputSearch(commandId)
+            searchedQuery = ""
+            scrollToEnd()
         }
     }
-  // 连接到命令管理器的输出更新信号
-    Connections {
-        target: commandManager
-        function onOutputUpdated(name) {
-            // 添加安全检查，确保窗口存在且可见，组件已初始化，并且是当前命令
-            if (outputWindow && outputWindow.visible && componentReady && currentCommand === name) {
-                updateOutput()
-            }
+
+    function reloadOutput() {
+        logModel = null
+        updateOutput()
+    }
+
+    function runSearch() {
+        if (!search) return
+        searchedQuery = searchField.text
+        search.start(searchField.text, regexBox.checked, caseBox.checked)
+    }
+
+    // 跳到下一个/上一个匹配，并暂停自动滚动
+    function gotoMatch(forward) {
+        if (!search) return
+        var row = forward ? search.next() : search.previous()
+        if (row < 0) return
+        if (stderrOnly) row = logModel.rowForSource(row)
+        autoScroll = false
+        logView.positionViewAtIndex(row, ListView.Center)
+    }
+
+    // 定位到第一条不早于该时刻的行，并暂停自动滚动
+    function jumpToTime(time) {
+        if (!logModel) return
+        var row = logModel.rowAtTime(time)
+        if (row < 0) {
+            jumpField.Material.accent = Material.Red
+            return
+        }
+        jumpField.Material.accent = Material.LightBlue
+        autoScroll = false
+        logView.positionViewAtIndex(row, ListView.Beginning)
+    }
+
+    function scrollToEnd() {
+        if (autoScroll && logView.count > 0) {
+            logView.positionViewAtEnd()
         }
     }
     
@@ -77,6 +116,11 @@ ApplicationWindow {
         }
     }
 
+    // 已结束运行的输出归档浏览
+    RunHistoryDialog {
+        id: historyDialog
+    }
+
     // 工具栏 - 使用anchor定位固定在顶部
     Pane {
         id: toolbarPane
@@ -99,37 +143,147 @@ ApplicationWindow {
                 Material.accent: Material.primary
             }
 
+            Switch {
+                text: "时间"
+                checked: outputWindow.showTimestamps
+                onToggled: outputWindow.showTimestamps = checked
+            }
+
+            Switch {
+                text: "仅 stderr"
+                checked: outputWindow.stderrOnly
+                onToggled: {
+                    outputWindow.stderrOnly = checked
+                    outputWindow.updateOutput()
+                }
+            }
+
+            TextField {
+                id: jumpField
+                placeholderText: "跳转 hh:mm:ss"
+                Layout.preferredWidth: 120
+                selectByMouse: true
+                onAccepted: outputWindow.jumpToTime(text)
+            }
+
             Item { Layout.fillWidth: true }
 
             Button {
                 text: "刷新"
                 Material.background: Material.primary
                 Material.foreground: "white"
-                onClicked: outputWindow.updateOutput()
+                onClicked: outputWindow.reloadOutput()
             }
 
             Button {
                 text: "清空"
-                enabled: outputWindow.currentCommand && !commandManager.isRunning(outputWindow.currentCommand)
+                enabled: outputWindow.commandId && !commandManager.isRunning(outputWindow.commandId)
                 Material.background: Material.Orange
                 Material.foreground: "white"
                 onClicked: {
-                    if (outputWindow.currentCommand) {
-                        commandManager.clearOutput(outputWindow.currentCommand)
+                    if (outputWindow.commandId) {
+                        commandManager.clearOutput(outputWindow.commandId)
                         outputWindow.updateOutput()
                     }
                 }
             }
 
+            Button {
+                text: "历史"
+                enabled: outputWindow.commandId !== 0
+                Material.background: Material.primary
+                Material.foreground: "white"
+                onClicked: historyDialog.showHistory(outputWindow.commandId, outputWindow.currentCommand)
+            }
+
             Button {
                 text: "复制全部"
                 Material.background: Material.Grey
                 Material.foreground: "white"
                 onClicked: {
-                    textArea.selectAll()
-                    textArea.copy()
-                    textArea.deselect()
+                    if (outputWindow.commandId) {
+                        commandManager.copyOutput(outputWindow.commandId)
+                    }
+                }
+            }
+        }
+    }
+
+    // 查找栏
+    Pane {
+        id: searchPane
+        anchors.top: toolbarPane.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.margins: 16
+        anchors.topMargin: 8
+        height: 56
+        Material.elevation: 1
+
+        RowLayout {
+            anchors.fill: parent
+            spacing: 12
+
+            TextField {
+                id: searchField
+                Layout.fillWidth: true
+                placeholderText: "查找（回车搜索 / 下一个）"
+                selectByMouse: true
+                onAccepted: {
+                    if (text !== outputWindow.searchedQuery) {
+                        outputWindow.runSearch()
+                    } else {
+                        outputWindow.gotoMatch(true)
+                    }
+                }
+            }
+
+            CheckBox {
+                id: regexBox
+                text: "正则"
+                onToggled: outputWindow.searchedQuery = ""
+            }
+
+            CheckBox {
+                id: caseBox
+                text: "区分大小写"
+                onToggled: outputWindow.searchedQuery = ""
+            }
+
+            Label {
+                Layout.preferredWidth: 160
+                horizontalAlignment: Text.AlignRight
+                color: outputWindow.search && outputWindow.search.error !== "" ? Material.color(Material.Red)
+                                                                                : Material.hintTextColor
+                text: {
+                    var s = outputWindow.search
+                    if (!s) return ""
+                    if (s.error !== "") return s.error
+                    var text = (s.current > 0 ? s.current + " / " : "") + s.matchCount + " 个匹配"
+                    if (s.running && s.totalBytes > 0) {
+                        text += "（" + Math.floor(s.scannedBytes * 100 / s.totalBytes) + "%）"
+                    }
+                    return text
                 }
+                elide: Text.ElideRight
+            }
+
+            Button {
+                text: "上一个"
+                enabled: outputWindow.search && outputWindow.search.matchCount > 0
+                onClicked: outputWindow.gotoMatch(false)
+            }
+
+            Button {
+                text: "下一个"
+                enabled: outputWindow.search && outputWindow.search.matchCount > 0
+                onClicked: outputWindow.gotoMatch(true)
+            }
+
+            Button {
+                text: "停止"
+                visible: outputWindow.search && outputWindow.search.running
+                onClicked: outputWindow.search.cancel()
             }
         }
     }
@@ -137,7 +291,7 @@ ApplicationWindow {
     // 输出文本区域 - 使用anchor定位填充剩余空间
     Pane {
         id: outputPane
-        anchors.top: toolbarPane.bottom
+        anchors.top: searchPane.bottom
         anchors.left: parent.left
         anchors.right: parent.right
         anchors.bottom: parent.bottom
@@ -149,26 +303,59 @@ ApplicationWindow {
             color: "#1f1f1f"
             radius: 4
         }
-        ScrollView {
+        // 只为可见行创建委托，内存占用与窗口大小相关而与日志长度无关
+        ListView {
+            id: logView
             anchors.fill: parent
-        
-            TextArea {
-                id: textArea
-                readOnly: true
-                wrapMode: Text.Wrap
-                selectByMouse: true
-                font.family: "Consolas, 'Courier New', monospace"
-                font.pixelSize: 13
-                // Material Design 3 暗色主题用于终端
-                color: "#e8eaed"
-                
+            anchors.margins: 15
+            clip: true
+            model: outputWindow.logModel
+            reuseItems: true
+            boundsBehavior: Flickable.StopAtBounds
+
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: Item {
+                width: logView.width
+                height: lineRow.height
+
+                // 当前查找匹配所在的行
+                Rectangle {
+                    anchors.fill: parent
+                    visible: index === outputWindow.matchRow
+                    color: "#3d3a1f"
+                }
 
-                selectionColor: Material.accent
-                selectedTextColor: "#ffffff"
+                Row {
+                    id: lineRow
+                    width: parent.width
+                    spacing: 8
 
-                // 添加一些内边距
-                padding: 15
+                    // 行首到达时间，stderr 行用橙色标出
+                    Text {
+                        id: timeLabel
+                        visible: outputWindow.showTimestamps
+                        text: model.time
+                        font.family: "Consolas, 'Courier New', monospace"
+                        font.pixelSize: 13
+                        color: model.stream === 1 ? "#ffab91" : "#9aa0a6"
+                    }
+
+                    Text {
+                        width: parent.width - (timeLabel.visible ? timeLabel.width + parent.spacing : 0)
+                        // 带颜色的行使用解析后的 StyledText，其余行仍按纯文本显示
+                        text: model.styledText !== "" ? model.styledText : model.text
+                        wrapMode: Text.WrapAnywhere
+                        textFormat: model.styledText !== "" ? Text.StyledText : Text.PlainText
+                        font.family: "Consolas, 'Courier New', monospace"
+                        font.pixelSize: 13
+                        // Material Design 3 暗色主题用于终端，命中高亮模式的行用红色显示
+                        color: model.highlighted ? "#ff8a80" : "#e8eaed"
+                    }
+                }
             }
+
+            onCountChanged: outputWindow.scrollToEnd()
         }
     }
 }
@@ -0,0 +1,260 @@
+import QtQuick
+import QtQuick.Controls.Material
+import QtQuick.Controls
+import QtQuick.Layouts
+
+ApplicationWindow {
+    id: historyWindow
+    property real commandId: 0
+    property string currentCommand
+    // 运行记录、归档读取和搜索都在后台线程中进行，结果通过 history 的属性和 pageLoaded 信号返回
+    property var history: null
+    property var runs: history ? history.runs : []
+    property string currentArchive: history ? history.archive : ""
+    property real nextOffset: history ? history.nextOffset : 0
+    property real archiveSize: history ? history.archiveSize : 0
+    property bool archiveError: history ? history.archiveError : false
+    property var matches: history ? history.matches : []
+    property int matchIndex: -1
+    property bool openLatest: false   // 列表载入后打开最近一次运行
+
+    width: 900
+    height: 600
+    title: currentCommand ? "运行历史 - " + currentCommand : "运行历史"
+    visible: false
+
+    Material.theme: Material.Light
+    Material.primary: Material.Blue
+    Material.accent: Material.LightBlue
+    color: Material.backgroundColor
+
+    function showHistory(id, name) {
+        commandId = id
+        currentCommand = name
+        history = commandManager.runHistory(id)
+        reloadRuns()
+        show()
+        raise()
+        requestActivate()
+    }
+
+    function reloadRuns() {
+        if (!history) return
+        openLatest = true
+        history.reload()
+    }
+
+    onRunsChanged: {
+        if (!openLatest) return
+        openLatest = false
+        if (runs.length > 0) {
+            runList.currentIndex = 0
+            openRun(runs[0].archive)
+        } else {
+            openRun("")
+        }
+    }
+
+    // 归档按段读取，只载入当前查看的部分
+    function openRun(archive) {
+        matchIndex = -1
+        history.open(archive)
+    }
+
+    function loadMore() {
+        history.readMore()
+    }
+
+    function find() {
+        matchIndex = -1
+        history.find(searchField.text)
+    }
+
+    // 搜索结果到达后跳到第一个匹配
+    onMatchesChanged: {
+        if (matchIndex < 0 && matches.length > 0) {
+            gotoMatch(0)
+        }
+    }
+
+    function gotoMatch(index) {
+        matchIndex = index
+        // 从匹配位置之前一点开始读取，保留上下文
+        history.readFrom(Math.max(0, matches[index] - 512))
+    }
+
+    Connections {
+        target: historyWindow.history
+        function onPageLoaded(text, append) {
+            if (append) {
+                outputArea.append(text)
+            } else {
+                outputArea.text = text
+            }
+        }
+    }
+
+    function formatTime(ms) {
+        return ms ? new Date(ms).toLocaleString(Qt.locale(), "yyyy-MM-dd hh:mm:ss") : "-"
+    }
+
+    onClosing: function(close) {
+        close.accepted = false
+        if (history) {
+            history.close()
+        }
+        hide()
+    }
+
+    RowLayout {
+        anchors.fill: parent
+        anchors.margins: 16
+        spacing: 16
+
+        // 运行列表
+        ListView {
+            id: runList
+            Layout.preferredWidth: 280
+            Layout.fillHeight: true
+            clip: true
+            model: historyWindow.runs
+            spacing: 4
+
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: ItemDelegate {
+                width: runList.width
+                highlighted: ListView.isCurrentItem
+                onClicked: {
+                    runList.currentIndex = index
+                    historyWindow.openRun(modelData.archive)
+                }
+
+                contentItem: ColumnLayout {
+                    spacing: 2
+                    Label {
+                        text: historyWindow.formatTime(modelData.startedAt)
+                        font.pointSize: 11
+                        font.weight: Font.Medium
+                    }
+                    Label {
+                        text: modelData.finishedAt
+                              ? "退出码 " + modelData.exitCode + " · " + (modelData.durationMs / 1000).toFixed(1) + " 秒"
+                                + (modelData.peakRssKb ? " · 峰值 " + (modelData.peakRssKb / 1024).toFixed(1) + " MB" : "")
+                              : "运行中"
+                        font.pointSize: 10
+                        color: modelData.finishedAt && modelData.exitCode !== 0
+                               ? Material.color(Material.Red) : Material.hintTextColor
+                    }
+                }
+            }
+        }
+
+        ColumnLayout {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            spacing: 8
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 8
+
+                TextField {
+                    id: searchField
+                    placeholderText: "在本次运行的输出中搜索"
+                    Layout.fillWidth: true
+                    enabled: historyWindow.currentArchive !== ""
+                    onAccepted: historyWindow.find()
+                }
+
+                Label {
+                    Layout.maximumWidth: 240
+                    color: historyWindow.history && historyWindow.history.searchError !== ""
+                           ? Material.color(Material.Red) : Material.hintTextColor
+                    text: {
+                        var h = historyWindow.history
+                        if (!h) return ""
+                        if (h.searching) return "搜索中…"
+                        var text = historyWindow.matches.length > 0
+                                ? (historyWindow.matchIndex + 1) + " / " + historyWindow.matches.length
+                                : (searchField.text ? "无匹配" : "")
+                        return h.searchError !== "" ? h.searchError + (text ? "（" + text + "）" : "") : text
+                    }
+                    elide: Text.ElideRight
+                }
+
+                Button {
+                    text: "上一个"
+                    enabled: historyWindow.matchIndex > 0
+                    onClicked: historyWindow.gotoMatch(historyWindow.matchIndex - 1)
+                }
+
+                Button {
+                    text: "下一个"
+                    enabled: historyWindow.matchIndex + 1 < historyWindow.matches.length
+                    onClicked: historyWindow.gotoMatch(historyWindow.matchIndex + 1)
+                }
+
+                Button {
+                    text: "停止"
+                    visible: historyWindow.history && historyWindow.history.searching
+                    onClicked: historyWindow.history.cancelSearch()
+                }
+
+                Button {
+                    text: "刷新"
+                    Material.background: Material.primary
+                    Material.foreground: "white"
+                    onClicked: historyWindow.reloadRuns()
+                }
+            }
+
+            Pane {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                padding: 0
+                background: Rectangle {
+                    color: "#1f1f1f"
+                    radius: 4
+                }
+
+                ScrollView {
+                    anchors.fill: parent
+                    anchors.margins: 15
+
+                    TextArea {
+                        id: outputArea
+                        readOnly: true
+                        wrapMode: TextEdit.WrapAnywhere
+                        textFormat: TextEdit.PlainText
+                        font.family: "Consolas, 'Courier New', monospace"
+                        font.pixelSize: 13
+                        color: "#e8eaed"
+                        background: null
+                    }
+                }
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+
+                Label {
+                    text: historyWindow.currentArchive
+                          ? (historyWindow.archiveError ? "归档已损坏，" : "") + "已显示至 " + Math.round(historyWindow.nextOffset / 1024) + " KB / "
+                            + Math.round(historyWindow.archiveSize / 1024) + " KB"
+                          : "没有运行记录"
+                    color: Material.hintTextColor
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Button {
+                    text: "加载更多"
+                    enabled: !historyWindow.archiveError && !historyWindow.history.reading
+                             && historyWindow.nextOffset < historyWindow.archiveSize
+                    onClicked: historyWindow.loadMore()
+                }
+            }
+        }
+    }
+}